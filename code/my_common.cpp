@@ -24,8 +24,26 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 
+#if defined _WIN32
+#include <malloc.h>
+#endif
+
+#if defined _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <charconv>
+#include <chrono>
 #include <mutex>
+#include <thread>
 
 namespace MY {
 
@@ -40,11 +58,32 @@ usize sFormat(Span<char> dst, MY_ATTR_PRINTF_PARAM(const char* fmt), ...)
 	va_end(args);
 	if (n < 0)
 		return 0;
-	if (usize(n) > dst.size)
+	if (usize(n) >= dst.size)
 		return dst.size;
 	return usize(n) + 1 /* terminator */;
 }
 
+////////////////////////////////////////////////////////////
+// Type-safe Formatting
+
+template <typename T>
+static usize formatFloatImpl(char* dst, T v)
+{
+	auto result = std::to_chars(dst, dst + FloatFormatSize_, v);
+	MY_ASSERT(result.ec == std::errc(), 0);
+	return usize(result.ptr - dst);
+}
+
+usize formatFloat_(char* dst, f32 v)
+{
+	return formatFloatImpl(dst, v);
+}
+
+usize formatFloat_(char* dst, f64 v)
+{
+	return formatFloatImpl(dst, v);
+}
+
 ////////////////////////////////////////////////////////////
 // Assertion
 
@@ -55,8 +94,70 @@ constinit OnAssert* onAssert = +[](const char*, const char*, long) noexcept { ab
 
 thread_local char g_logBuffer[MY_LOG_BUFFER_SIZE];
 
+constinit std::atomic<LogSeverity> g_logMinSeverity = LogSeverity::Trace;
+
 static constinit std::mutex g_logMutex;
 
+static constinit std::atomic<u64> g_logTruncationCount = 0;
+
+// Reset for every spilled message; chunks are retained for reuse.
+static thread_local ArenaAllocator t_logSpillArena;
+
+const char* formatLogMessage_(const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	va_list retry;
+	va_copy(retry, args);
+	MY_DEFER(va_end(retry));
+
+	int n = vsnprintf(g_logBuffer, sizeof(g_logBuffer), fmt, args);
+	va_end(args);
+	if (n < 0 || usize(n) < sizeof(g_logBuffer))
+		return g_logBuffer;
+
+	usize size = usize(n) + 1 /* terminator */;
+	char* spill = nullptr;
+	if (size <= LogSpillMaxSize) {
+		t_logSpillArena.reset();
+		spill = static_cast<char*>(t_logSpillArena.alloc(size));
+	}
+	if (!spill) {
+		g_logTruncationCount.fetch_add(1, std::memory_order_relaxed);
+		return g_logBuffer;
+	}
+
+	vsnprintf(spill, size, fmt, retry);
+	return spill;
+}
+
+// Formats via format(Span<char>), which follows sFormat, into g_logBuffer. As
+// the formatters only report the truncated size, a message filling the whole
+// buffer is formatted again into the spill arena with doubling size.
+template <typename Format>
+static const char* formatLogSpilled(Format format)
+{
+	if (format(Span<char>(g_logBuffer)) + 1 < sizeof(g_logBuffer))
+		return g_logBuffer;
+
+	for (usize size = 2 * sizeof(g_logBuffer); size <= LogSpillMaxSize; size *= 2) {
+		t_logSpillArena.reset();
+		auto* spill = static_cast<char*>(t_logSpillArena.alloc(size));
+		if (!spill)
+			break;
+		if (format(Span(spill, size)) + 1 < size)
+			return spill;
+	}
+
+	g_logTruncationCount.fetch_add(1, std::memory_order_relaxed);
+	return g_logBuffer;
+}
+
+u64 logTruncationCount()
+{
+	return g_logTruncationCount.load(std::memory_order_relaxed);
+}
+
 constinit OnLog* onLog = +[](LogSeverity severity, const char* msg, const char* file, long line) noexcept {
 	std::lock_guard guard(g_logMutex);
 	printf("%c [%s:%ld] %s\n", toChar(severity), file, line, msg);
@@ -66,13 +167,1756 @@ constinit OnLog* onLog = +[](LogSeverity severity, const char* msg, const char*
 };
 
 ////////////////////////////////////////////////////////////
-// Allocator
+// Rate-limited Logging
 
-constinit Allocator g_defaultAllocator(
-    +[](void*, usize size, usize alignment) noexcept -> void* {
-	    MY_ASSERT(alignment == 1, nullptr);
-	    return malloc(size);
-    },
-    +[](void*, void* ptr) noexcept { return free(ptr); }, nullptr);
+u64 logTimeMs_()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return u64(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+}
+
+const char* appendSuppressedCount_(const char* msg, u64 suppressed)
+{
+	if (suppressed == 0)
+		return msg;
+
+	char suffix[32];
+	usize suffixSize = sFormat(suffix, " (%llu suppressed)", (unsigned long long)suppressed);
+	usize size = sLength(msg);
+	if (msg == g_logBuffer && size + suffixSize < sizeof(g_logBuffer)) {
+		memcpy(g_logBuffer + size, suffix, suffixSize + 1);
+		return g_logBuffer;
+	}
+
+	// The arena is not reset, hence msg stays valid if it was spilled.
+	char* spill = nullptr;
+	if (size + suffixSize < LogSpillMaxSize) {
+		spill = static_cast<char*>(t_logSpillArena.alloc(size + suffixSize + 1));
+	}
+	if (!spill) {
+		g_logTruncationCount.fetch_add(1, std::memory_order_relaxed);
+		return msg;
+	}
+	memcpy(spill, msg, size);
+	memcpy(spill + size, suffix, suffixSize + 1);
+	return spill;
+}
+
+////////////////////////////////////////////////////////////
+// String Utilities
+
+namespace {
+
+constexpr f32 FloatPowersOf10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+constexpr f64 DoublePowersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Mantissa and power of 10 are exactly representable below these limits,
+// hence a single multiplication / division rounds correctly.
+template <typename T, usize PowerCount>
+const char* parseFloat(Span<const char> s, T* out, u64 maxMantissa, const T (&powers)[PowerCount])
+{
+	const char* p = s.begin();
+	const char* end = s.end();
+
+	bool negative = false;
+	if (p < end && (*p == '+' || *p == '-')) {
+		negative = *p == '-';
+		p++;
+	}
+	const char* start = p;
+
+	// Leading zeros are skipped to count significant digits only.
+	u64 mantissa = 0;
+	i64 exponent = 0;
+	while (p < end && *p == '0')
+		p++;
+	const char* integer = p;
+	p = parseDigits_(p, end, &mantissa);
+	usize count = usize(p - integer);
+
+	if (p < end && *p == '.') {
+		const char* fraction = ++p;
+		if (count == 0) {
+			while (p < end && *p == '0')
+				p++;
+		}
+		const char* significant = p;
+		p = parseDigits_(p, end, &mantissa);
+		count += usize(p - significant);
+		exponent = -i64(p - fraction);
+		if (p == start + 1) { // just "."
+			p = start;
+		}
+	}
+
+	if (p == start) {
+		// inf, infinity or nan
+		T value;
+		if (p == end || *p == '+' || *p == '-')
+			return nullptr;
+		auto result = std::from_chars(p, end, value);
+		if (result.ec != std::errc())
+			return nullptr;
+		*out = negative ? -value : value;
+		return result.ptr;
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char* e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '+' || *e == '-')) {
+			negativeExponent = *e == '-';
+			e++;
+		}
+		if (e < end && u8(*e - '0') < 10) {
+			i64 value = 0;
+			for (; e < end && u8(*e - '0') < 10; e++) {
+				if (value < 100000) {
+					value = value * 10 + (*e - '0');
+				}
+			}
+			exponent += negativeExponent ? -value : value;
+			p = e;
+		}
+	}
+
+	if (count == 0) {
+		*out = negative ? -T(0) : T(0);
+		return p;
+	}
+
+	i64 maxExponent = i64(PowerCount - 1);
+	if (count <= 19 && mantissa <= maxMantissa && exponent >= -maxExponent && exponent <= maxExponent) {
+		T value = T(mantissa);
+		value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+		*out = negative ? -value : value;
+		return p;
+	}
+
+	T value;
+	auto result = std::from_chars(start, p, value);
+	if (result.ec != std::errc() || result.ptr != p)
+		return nullptr;
+	*out = negative ? -value : value;
+	return p;
+}
+
+} // namespace
+
+const char* sToF(Span<const char> s, f32* out)
+{
+	return parseFloat(s, out, u64(1) << 24, FloatPowersOf10);
+}
+
+const char* sToF(Span<const char> s, f64* out)
+{
+	return parseFloat(s, out, u64(1) << 53, DoublePowersOf10);
+}
+
+////////////////////////////////////////////////////////////
+// Deferred Logging
+
+constinit OnLogDeferred* onLogDeferred = nullptr;
+
+thread_local u8 g_logDeferredBuffer[MY_LOG_BUFFER_SIZE];
+
+void dispatchDeferredLog_(LogSeverity severity, Span<const u8> record, const char* file, long line)
+{
+	if (onLogDeferred) {
+		onLogDeferred(severity, record, file, line);
+	}
+	else if (onLog) {
+		const char* msg = formatLogSpilled([&](Span<char> dst) { return formatDeferredLog(dst, record); });
+		onLog(severity, msg, file, line);
+	}
+}
+
+namespace {
+
+struct DeferredLogValue {
+	DeferredLogArg type = DeferredLogArg::Int;
+	u64 bits = 0;
+	const char* string = nullptr;
+
+	i64 asInt() const { return type == DeferredLogArg::Double ? i64(asDouble()) : i64(bits); }
+	u64 asUInt() const { return type == DeferredLogArg::Double ? u64(asDouble()) : bits; }
+	f64 asDouble() const
+	{
+		if (type == DeferredLogArg::Double)
+			return std::bit_cast<f64>(bits);
+		return type == DeferredLogArg::Int ? f64(i64(bits)) : f64(bits);
+	}
+};
+
+struct DeferredLogReader {
+	bool next(DeferredLogValue* value)
+	{
+		if (offset_ + 1 > record_.size)
+			return false;
+		value->type = DeferredLogArg(record_.data[offset_++]);
+
+		if (value->type == DeferredLogArg::String) {
+			u32 length = 0;
+			if (!read(&length) || usize(length) + 1 > record_.size - offset_)
+				return false;
+			value->string = reinterpret_cast<const char*>(record_.data + offset_);
+			offset_ += usize(length) + 1;
+			return true;
+		}
+		return read(&value->bits);
+	}
+
+	template <typename T>
+	bool read(T* v)
+	{
+		if (sizeof(T) > record_.size - offset_)
+			return false;
+		memcpy(v, record_.data + offset_, sizeof(T));
+		offset_ += sizeof(T);
+		return true;
+	}
+
+	Span<const u8> record_;
+	usize offset_ = 0;
+};
+
+struct DeferredLogSpec {
+	const char* format = nullptr;
+	bool starWidth = false;
+	bool starPrecision = false;
+	int width = 0;
+	int precision = 0;
+};
+
+// Formats a single value, passing width / precision arguments if requested by
+// the conversion specification.
+template <typename T>
+int formatDeferredLogValue(char* dst, usize size, const DeferredLogSpec& spec, T value)
+{
+	if (spec.starWidth && spec.starPrecision)
+		return snprintf(dst, size, spec.format, spec.width, spec.precision, value);
+	if (spec.starWidth)
+		return snprintf(dst, size, spec.format, spec.width, value);
+	if (spec.starPrecision)
+		return snprintf(dst, size, spec.format, spec.precision, value);
+	return snprintf(dst, size, spec.format, value);
+}
+
+int formatDeferredLogArg(
+    char* dst, usize size, const DeferredLogSpec& spec, const char* length, char conversion, const DeferredLogValue& v)
+{
+	auto is = [&](const char* l) { return sEq(length, l); };
+
+	switch (conversion) {
+	case 'd':
+	case 'i':
+		if (is("l"))
+			return formatDeferredLogValue(dst, size, spec, long(v.asInt()));
+		if (is("ll"))
+			return formatDeferredLogValue(dst, size, spec, (long long)(v.asInt()));
+		if (is("j"))
+			return formatDeferredLogValue(dst, size, spec, intmax_t(v.asInt()));
+		if (is("z") || is("t"))
+			return formatDeferredLogValue(dst, size, spec, ptrdiff_t(v.asInt()));
+		return formatDeferredLogValue(dst, size, spec, int(v.asInt()));
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		if (is("l"))
+			return formatDeferredLogValue(dst, size, spec, (unsigned long)(v.asUInt()));
+		if (is("ll"))
+			return formatDeferredLogValue(dst, size, spec, (unsigned long long)(v.asUInt()));
+		if (is("j"))
+			return formatDeferredLogValue(dst, size, spec, uintmax_t(v.asUInt()));
+		if (is("z") || is("t"))
+			return formatDeferredLogValue(dst, size, spec, size_t(v.asUInt()));
+		return formatDeferredLogValue(dst, size, spec, unsigned(v.asUInt()));
+	case 'c': return formatDeferredLogValue(dst, size, spec, int(v.asInt()));
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		if (is("L"))
+			return formatDeferredLogValue(dst, size, spec, (long double)(v.asDouble()));
+		return formatDeferredLogValue(dst, size, spec, v.asDouble());
+	case 's':
+		return formatDeferredLogValue(dst, size, spec, v.type == DeferredLogArg::String ? v.string : "(?)");
+	case 'p': return formatDeferredLogValue(dst, size, spec, reinterpret_cast<void*>(uintptr_t(v.bits)));
+	}
+	return snprintf(dst, size, "%s", spec.format);
+}
+
+} // namespace
+
+usize formatDeferredLog(Span<char> dst, Span<const u8> record)
+{
+	MY_ASSERT(dst.size > 0, 0);
+
+	DeferredLogReader reader{record};
+	const char* fmt = nullptr;
+	MY_ASSERT(reader.read(&fmt), 0);
+
+	usize pos = 0;
+	auto advance = [&](int n) {
+		if (n > 0) {
+			pos += min(usize(n), dst.size - 1 - pos);
+		}
+	};
+	auto append = [&](const char* s, usize n) {
+		n = min(n, dst.size - 1 - pos);
+		memcpy(dst.data + pos, s, n);
+		pos += n;
+	};
+
+	const char* p = fmt;
+	while (*p) {
+		if (*p != '%') {
+			const char* text = p;
+			while (*p && *p != '%')
+				p++;
+			append(text, usize(p - text));
+			continue;
+		}
+		if (p[1] == '%') {
+			append("%", 1);
+			p += 2;
+			continue;
+		}
+
+		// Split the conversion specification: %[flags][width][.precision][length]conversion
+		const char* start = p++;
+		DeferredLogSpec spec;
+		while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+			p++;
+		if (*p == '*') {
+			spec.starWidth = true;
+			p++;
+		}
+		while ('0' <= *p && *p <= '9')
+			p++;
+		if (*p == '.') {
+			p++;
+			if (*p == '*') {
+				spec.starPrecision = true;
+				p++;
+			}
+			while ('0' <= *p && *p <= '9')
+				p++;
+		}
+		const char* lengthStart = p;
+		while (*p == 'h' || *p == 'l' || *p == 'j' || *p == 'z' || *p == 't' || *p == 'L')
+			p++;
+		char length[3] = {};
+		if (p - lengthStart < 3) {
+			memcpy(length, lengthStart, usize(p - lengthStart));
+		}
+		char conversion = *p;
+		if (!conversion)
+			break;
+		p++;
+
+		char format[32] = {};
+		if (usize(p - start) >= sizeof(format)) {
+			append(start, usize(p - start));
+			continue;
+		}
+		memcpy(format, start, usize(p - start));
+		spec.format = format;
+
+		// Truncated records lack trailing arguments.
+		DeferredLogValue value;
+		bool complete = true;
+		if (spec.starWidth) {
+			complete = complete && reader.next(&value);
+			spec.width = int(value.asInt());
+		}
+		if (spec.starPrecision) {
+			complete = complete && reader.next(&value);
+			spec.precision = int(value.asInt());
+		}
+		complete = complete && reader.next(&value);
+		if (!complete) {
+			append("<?>", 3);
+			continue;
+		}
+
+		advance(formatDeferredLogArg(dst.data + pos, dst.size - pos, spec, length, conversion, value));
+	}
+
+	dst.data[pos] = '\0';
+	return pos + 1;
+}
+
+////////////////////////////////////////////////////////////
+// Structured Logging
+
+constinit OnLogRecord* onLogRecord = nullptr;
+
+thread_local u8 g_logRecordBuffer[MY_LOG_BUFFER_SIZE];
+
+void dispatchLogRecord_(const LogRecord* record)
+{
+	if (onLogRecord) {
+		onLogRecord(record);
+	}
+	else if (onLog) {
+		const char* msg = formatLogSpilled([&](Span<char> dst) { return formatLogRecordText(dst, record); });
+		onLog(record->severity, msg, record->file, record->line);
+	}
+}
+
+namespace {
+
+template <typename T>
+bool readLogFieldValue(Span<const u8> fields, usize* offset, T* v)
+{
+	if (sizeof(T) > fields.size - *offset)
+		return false;
+	memcpy(v, fields.data + *offset, sizeof(T));
+	*offset += sizeof(T);
+	return true;
+}
+
+// Appends to a null-terminated string, silently truncating once dst is full.
+// The last reserved characters are held back, e.g. for closing brackets, and
+// truncated records whether anything has been cut.
+struct LogRecordPrinter {
+	usize available() const { return dst.size > size + reserved ? dst.size - 1 - reserved - size : 0; }
+
+	void raw(const char* s, usize length)
+	{
+		if (dst.size == 0)
+			return;
+		if (length > available()) {
+			length = available();
+			truncated = true;
+		}
+		memcpy(dst.data + size, s, length);
+		size += length;
+		dst.data[size] = '\0';
+	}
+
+	void raw(const char* s) { raw(s, sLength(s)); }
+
+	Span<char> rest() { return dst.subspan(size, available() + 1); }
+
+	// Accepts the result of sFormat on rest(), which fills it when truncated.
+	void advance(usize written)
+	{
+		if (written > 0) {
+			truncated |= written > available();
+			size += min(written - 1, available());
+		}
+	}
+
+	// Discards everything written after mark.
+	void rollback(usize mark)
+	{
+		size = mark;
+		if (dst.size > 0) {
+			dst.data[size] = '\0';
+		}
+	}
+
+	// Escape sequences are never split, and the closing quote is written even
+	// if s is cut short. Returns false, writing nothing, if the quotes don't
+	// fit.
+	bool jsonString(Span<const char> s)
+	{
+		if (available() < 2) {
+			truncated = true;
+			return false;
+		}
+
+		raw("\"", 1);
+		reserved++;
+		for (char c : s) {
+			char escape[8];
+			const char* piece = escape;
+			usize length = 2;
+			switch (c) {
+			case '"': piece = "\\\""; break;
+			case '\\': piece = "\\\\"; break;
+			case '\n': piece = "\\n"; break;
+			case '\r': piece = "\\r"; break;
+			case '\t': piece = "\\t"; break;
+			default:
+				if (u8(c) < 0x20) {
+					length = sFormat(escape, "\\u%04x", unsigned(c)) - 1;
+				}
+				else {
+					piece = &c;
+					length = 1;
+				}
+			}
+			if (length > available()) {
+				truncated = true;
+				break;
+			}
+			raw(piece, length);
+		}
+		reserved--;
+		raw("\"", 1);
+		return true;
+	}
+
+	void value(const LogField* field, bool json)
+	{
+		switch (field->type) {
+		case LogFieldType::Bool: raw(field->b ? "true" : "false"); break;
+		case LogFieldType::Int: advance(sFormat(rest(), "%lld", (long long)field->i)); break;
+		case LogFieldType::UInt: advance(sFormat(rest(), "%llu", (unsigned long long)field->u)); break;
+		case LogFieldType::Double:
+			if (json && !isfinite(field->d)) {
+				raw("null");
+			}
+			else {
+				advance(sFormat(rest(), json ? "%.17g" : "%g", field->d));
+			}
+			break;
+		case LogFieldType::String:
+			if (json) {
+				jsonString(field->string);
+			}
+			else {
+				raw(field->string.data, field->string.size);
+			}
+			break;
+		}
+	}
+
+	usize finish() const { return dst.size == 0 ? 0 : size + 1 /* terminator */; }
+
+	Span<char> dst;
+	usize size = 0;
+	usize reserved = 0;
+	bool truncated = false;
+};
+
+struct LogRecordFrame {
+	u32 size = 0; // including this header
+	u8 severity = 0;
+	u8 reserved[3] = {};
+	u32 line = 0;
+	u32 messageSize = 0; // including terminator
+	u32 fileSize = 0; // including terminator
+	u32 fieldsSize = 0;
+};
+
+} // namespace
+
+bool nextLogField(Span<const u8>* fields, LogField* field)
+{
+	Span<const u8> f = *fields;
+	if (f.size < 2)
+		return false;
+
+	auto type = LogFieldType(f.data[0]);
+	usize keyLength = f.data[1];
+	if (type > LogFieldType::String || keyLength + 1 > f.size - 2 || f.data[2 + keyLength] != '\0')
+		return false;
+
+	*field = LogField{};
+	field->key = reinterpret_cast<const char*>(f.data + 2);
+	field->type = type;
+
+	usize offset = 2 + keyLength + 1;
+	switch (type) {
+	case LogFieldType::Bool: {
+		u8 b = 0;
+		if (!readLogFieldValue(f, &offset, &b))
+			return false;
+		field->b = b != 0;
+		break;
+	}
+	case LogFieldType::Int:
+		if (!readLogFieldValue(f, &offset, &field->i))
+			return false;
+		break;
+	case LogFieldType::UInt:
+		if (!readLogFieldValue(f, &offset, &field->u))
+			return false;
+		break;
+	case LogFieldType::Double:
+		if (!readLogFieldValue(f, &offset, &field->d))
+			return false;
+		break;
+	case LogFieldType::String: {
+		u32 length = 0;
+		if (!readLogFieldValue(f, &offset, &length) || usize(length) + 1 > f.size - offset
+		    || f.data[offset + length] != '\0')
+			return false;
+		field->string = Span(reinterpret_cast<const char*>(f.data + offset), length);
+		offset += usize(length) + 1;
+		break;
+	}
+	}
+
+	*fields = f.subspan(offset);
+	return true;
+}
+
+usize formatLogRecordText(Span<char> dst, const LogRecord* record)
+{
+	LogRecordPrinter printer{dst};
+	printer.raw(record->message);
+
+	LogField field;
+	for (Span<const u8> fields = record->fields; nextLogField(&fields, &field);) {
+		printer.raw(" ", 1);
+		printer.raw(field.key);
+		printer.raw("=", 1);
+		printer.value(&field, false);
+	}
+	return printer.finish();
+}
+
+usize formatLogRecordJson(Span<char> dst, const LogRecord* record, bool* truncated)
+{
+	constexpr const char* severities[] = {"trace", "info", "warning", "error"};
+
+	// Room for closing the object is held back. Members which don't fit are
+	// dropped as a whole, except for the message, which is cut short.
+	LogRecordPrinter printer{dst};
+	printer.reserved = 2;
+	printer.raw("{\"severity\":\"");
+	printer.raw(severities[usize(record->severity)]);
+	printer.raw("\",\"file\":");
+	printer.jsonString(Span(record->file, sLength(record->file)));
+	printer.advance(sFormat(printer.rest(), ",\"line\":%ld", record->line));
+	if (printer.truncated) {
+		printer.rollback(min(printer.size, usize(1)));
+	}
+	else {
+		usize mark = printer.size;
+		printer.raw(",\"message\":");
+		if (printer.truncated || !printer.jsonString(Span(record->message, sLength(record->message))))
+			printer.rollback(mark);
+	}
+
+	LogField field;
+	for (Span<const u8> fields = record->fields; !printer.truncated && nextLogField(&fields, &field);) {
+		usize mark = printer.size;
+		printer.raw(",", 1);
+		printer.jsonString(Span(field.key, sLength(field.key)));
+		printer.raw(":", 1);
+		printer.value(&field, true);
+		if (printer.truncated)
+			printer.rollback(mark);
+	}
+
+	printer.reserved = 0;
+	printer.raw("}\n");
+	if (truncated) {
+		*truncated = printer.truncated;
+	}
+	return printer.finish();
+}
+
+usize encodeLogRecord(Span<u8> dst, const LogRecord* record)
+{
+	LogRecordFrame frame;
+	frame.severity = u8(record->severity);
+	frame.line = u32(record->line);
+	frame.messageSize = u32(sLength(record->message) + 1);
+	frame.fileSize = u32(sLength(record->file) + 1);
+	frame.fieldsSize = u32(record->fields.size);
+
+	usize size = sizeof(frame) + frame.messageSize + frame.fileSize + frame.fieldsSize;
+	if (size > dst.size || size > UINT32_MAX)
+		return 0;
+	frame.size = u32(size);
+
+	u8* p = dst.data;
+	memcpy(p, &frame, sizeof(frame));
+	p += sizeof(frame);
+	memcpy(p, record->message, frame.messageSize);
+	p += frame.messageSize;
+	memcpy(p, record->file, frame.fileSize);
+	p += frame.fileSize;
+	memcpy(p, record->fields.data, frame.fieldsSize);
+	return size;
+}
+
+usize decodeLogRecord(Span<const u8> src, LogRecord* record)
+{
+	LogRecordFrame frame;
+	if (src.size < sizeof(frame))
+		return 0;
+	memcpy(&frame, src.data, sizeof(frame));
+
+	if (frame.size > src.size || frame.messageSize == 0 || frame.fileSize == 0
+	    || frame.size != sizeof(frame) + usize(frame.messageSize) + frame.fileSize + frame.fieldsSize
+	    || frame.severity > u8(LogSeverity::Error))
+		return 0;
+
+	auto* message = reinterpret_cast<const char*>(src.data + sizeof(frame));
+	auto* file = message + frame.messageSize;
+	if (message[frame.messageSize - 1] != '\0' || file[frame.fileSize - 1] != '\0')
+		return 0;
+
+	Span<const u8> fields(reinterpret_cast<const u8*>(file + frame.fileSize), frame.fieldsSize);
+
+	// Reject malformed fields upfront so sinks can rely on nextLogField
+	// consuming all of them.
+	LogField field;
+	Span<const u8> rest = fields;
+	while (nextLogField(&rest, &field)) {}
+	if (rest.size != 0)
+		return 0;
+
+	record->severity = LogSeverity(frame.severity);
+	record->message = message;
+	record->file = file;
+	record->line = long(frame.line);
+	record->fields = fields;
+	return frame.size;
+}
+
+void logRecordJsonSink(const LogRecord* record) noexcept
+{
+	// Reporting truncated records as filling dst makes them spill.
+	const char* json = formatLogSpilled([&](Span<char> dst) {
+		bool truncated = false;
+		usize size = formatLogRecordJson(dst, record, &truncated);
+		return truncated ? dst.size : size;
+	});
+
+	std::lock_guard guard(g_logMutex);
+	fwrite(json, 1, sLength(json), stdout);
+	if (record->severity >= LogSeverity::Warning) {
+		fflush(stdout);
+	}
+}
+
+void logRecordBinarySink(const LogRecord* record) noexcept
+{
+	static thread_local u8 buffer[4 * MY_LOG_BUFFER_SIZE];
+	usize size = encodeLogRecord(buffer, record);
+	if (size == 0)
+		return;
+
+	std::lock_guard guard(g_logMutex);
+	fwrite(buffer, 1, size, stdout);
+	if (record->severity >= LogSeverity::Warning) {
+		fflush(stdout);
+	}
+}
+
+////////////////////////////////////////////////////////////
+// Async Logging
+
+namespace {
+
+struct AsyncLogRecord {
+	enum Flags : u32 {
+		Skip = 1 << 0, // marks unused space at the end of the ring
+		Deferred = 1 << 1, // payload is a deferred log record
+	};
+
+	u32 size = 0; // including this header and padding
+	u32 flags = 0;
+	u32 payloadSize = 0;
+	LogSeverity severity = LogSeverity::Info;
+	long line = 0;
+	const char* file = nullptr;
+};
+
+// Skip records only consist of size and flags, as the space left before the
+// end of the ring may be smaller than a full header.
+constexpr usize AsyncLogSkipSize = 2 * sizeof(u32);
+static_assert(alignof(AsyncLogRecord) >= AsyncLogSkipSize);
+
+struct alignas(CacheLineSize) AsyncLogRing {
+	u8* data = nullptr;
+	usize capacity = 0;
+	std::atomic<bool> abandoned = false;
+	bool reclaim = false; // consumer-only
+	AsyncLogRing* next = nullptr;
+
+	// Producer and consumer positions increase monotonically and are kept on
+	// separate cache lines.
+	alignas(CacheLineSize) std::atomic<usize> head = 0;
+	usize cachedTail = 0;
+	alignas(CacheLineSize) std::atomic<usize> tail = 0;
+};
+
+struct AsyncLogRingOwner {
+	~AsyncLogRingOwner() noexcept
+	{
+		if (ring) {
+			ring->abandoned.store(true, std::memory_order_release);
+		}
+	}
+
+	AsyncLogRing* ring = nullptr;
+};
+
+constinit std::mutex g_asyncLogMutex; // guards ring list modification and start / stop
+constinit AsyncLogRing* g_asyncLogRings = nullptr;
+constinit UnmanagedStorage<std::thread> g_asyncLogThread;
+constinit OnLog* g_asyncLogSink = nullptr;
+constinit OnLog* g_asyncLogPrevious = nullptr;
+constinit OnLogDeferred* g_asyncLogPreviousDeferred = nullptr;
+constinit std::atomic<usize> g_asyncLogRingSize = 0;
+constinit std::atomic<bool> g_asyncLogRunning = false;
+constinit std::atomic<u64> g_asyncLogDropCount = 0;
+constinit std::atomic<u64> g_asyncLogFlushRequest = 0;
+constinit std::atomic<u64> g_asyncLogFlushDone = 0;
+
+thread_local AsyncLogRingOwner t_asyncLogRingOwner;
+
+AsyncLogRing* asyncLogRing()
+{
+	if (AsyncLogRing* ring = t_asyncLogRingOwner.ring) {
+		if (ring->capacity == g_asyncLogRingSize.load(std::memory_order_relaxed))
+			return ring;
+
+		// Restarted with a different ring size; the old ring is reclaimed by
+		// the consumer once drained.
+		ring->abandoned.store(true, std::memory_order_release);
+		t_asyncLogRingOwner.ring = nullptr;
+	}
+
+	std::lock_guard guard(g_asyncLogMutex);
+	void* ring = g_defaultAllocator.alloc(sizeof(AsyncLogRing), alignof(AsyncLogRing));
+	void* data = g_defaultAllocator.alloc(g_asyncLogRingSize.load(std::memory_order_relaxed), alignof(AsyncLogRecord));
+	if (!ring || !data) {
+		g_defaultAllocator.dealloc(ring);
+		g_defaultAllocator.dealloc(data);
+		return nullptr;
+	}
+
+	auto* r = std::construct_at(static_cast<AsyncLogRing*>(ring));
+	r->data = static_cast<u8*>(data);
+	r->capacity = g_asyncLogRingSize.load(std::memory_order_relaxed);
+	r->next = g_asyncLogRings;
+	g_asyncLogRings = r;
+	t_asyncLogRingOwner.ring = r;
+	return r;
+}
+
+void asyncLogPushRecord(
+    LogSeverity severity, u32 flags, Span<const u8> payload, const char* file, long line) noexcept
+{
+	AsyncLogRing* ring = asyncLogRing();
+	if (!ring) {
+		g_asyncLogDropCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// Overly long messages are truncated to keep the ring usable. The
+	// payload is always followed by a terminator.
+	usize length = min(payload.size, ring->capacity / 4);
+	if (length < payload.size) {
+		g_logTruncationCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	usize size = alignUp(sizeof(AsyncLogRecord) + length + 1, alignof(AsyncLogRecord));
+
+	usize mask = ring->capacity - 1;
+	usize head = ring->head.load(std::memory_order_relaxed);
+	usize contiguous = ring->capacity - (head & mask);
+	usize needed = contiguous < size ? contiguous + size : size;
+
+	if (needed > ring->capacity - (head - ring->cachedTail)) {
+		ring->cachedTail = ring->tail.load(std::memory_order_acquire);
+		if (needed > ring->capacity - (head - ring->cachedTail)) {
+			g_asyncLogDropCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	if (contiguous < size) {
+		u32 skip[2] = {u32(contiguous), AsyncLogRecord::Skip};
+		memcpy(ring->data + (head & mask), skip, AsyncLogSkipSize);
+		head += contiguous;
+	}
+
+	u8* dst = ring->data + (head & mask);
+	std::construct_at(
+	    reinterpret_cast<AsyncLogRecord*>(dst), AsyncLogRecord{u32(size), flags, u32(length), severity, line, file});
+	memcpy(dst + sizeof(AsyncLogRecord), payload.data, length);
+	dst[sizeof(AsyncLogRecord) + length] = '\0';
+
+	ring->head.store(head + size, std::memory_order_release);
+}
+
+void asyncLogPush(LogSeverity severity, const char* msg, const char* file, long line) noexcept
+{
+	auto payload = Span<const char>(msg, sLength(msg)).as<const u8>();
+	asyncLogPushRecord(severity, 0, payload, file, line);
+}
+
+void asyncLogPushDeferred(LogSeverity severity, Span<const u8> record, const char* file, long line) noexcept
+{
+	asyncLogPushRecord(severity, AsyncLogRecord::Deferred, record, file, line);
+}
+
+void asyncLogWriteStdout(LogSeverity severity, const char* msg, const char* file, long line) noexcept
+{
+	// Only called from the consumer thread, no locking needed. stdout is
+	// flushed after each batch.
+	fprintf(stdout, "%c [%s:%ld] %s\n", toChar(severity), file, line, msg);
+}
+
+// Hands all pending records of all rings to the sink. Returns the number of
+// forwarded records.
+//
+// Rings are only unlinked by the consumer, hence the list can be walked
+// without holding the lock; new rings are only ever prepended.
+usize asyncLogDrain()
+{
+	AsyncLogRing* rings = nullptr;
+	{
+		std::lock_guard guard(g_asyncLogMutex);
+		rings = g_asyncLogRings;
+	}
+
+	usize count = 0;
+	bool reclaim = false;
+	for (AsyncLogRing* ring = rings; ring; ring = ring->next) {
+		// Check for abandonment before draining, so that no record is missed.
+		ring->reclaim = ring->abandoned.load(std::memory_order_acquire);
+		reclaim |= ring->reclaim;
+
+		usize mask = ring->capacity - 1;
+		usize tail = ring->tail.load(std::memory_order_relaxed);
+		usize head = ring->head.load(std::memory_order_acquire);
+		while (tail != head) {
+			u32 prefix[2];
+			memcpy(prefix, ring->data + (tail & mask), AsyncLogSkipSize);
+			if (prefix[1] & AsyncLogRecord::Skip) {
+				tail += prefix[0];
+				ring->tail.store(tail, std::memory_order_release);
+				continue;
+			}
+
+			auto* record = reinterpret_cast<const AsyncLogRecord*>(ring->data + (tail & mask));
+			if (record->flags & AsyncLogRecord::Deferred) {
+				auto payload = Span(reinterpret_cast<const u8*>(record + 1), record->payloadSize);
+				const char* msg = formatLogSpilled([&](Span<char> dst) { return formatDeferredLog(dst, payload); });
+				g_asyncLogSink(record->severity, msg, record->file, record->line);
+				count++;
+			}
+			else {
+				auto* msg = reinterpret_cast<const char*>(record + 1);
+				g_asyncLogSink(record->severity, msg, record->file, record->line);
+				count++;
+			}
+			tail += record->size;
+			ring->tail.store(tail, std::memory_order_release);
+		}
+	}
+
+	if (count > 0 && g_asyncLogSink == asyncLogWriteStdout) {
+		fflush(stdout);
+	}
+
+	if (reclaim) {
+		std::lock_guard guard(g_asyncLogMutex);
+		AsyncLogRing** link = &g_asyncLogRings;
+		while (AsyncLogRing* ring = *link) {
+			if (ring->reclaim) {
+				*link = ring->next;
+				g_defaultAllocator.dealloc(ring->data);
+				std::destroy_at(ring);
+				g_defaultAllocator.dealloc(ring);
+			}
+			else {
+				link = &ring->next;
+			}
+		}
+	}
+
+	return count;
+}
+
+void asyncLogRun()
+{
+	for (;;) {
+		// A flush request is only completed by a drain pass started after it.
+		u64 flushRequest = g_asyncLogFlushRequest.load(std::memory_order_acquire);
+		bool running = g_asyncLogRunning.load(std::memory_order_acquire);
+
+		usize count = asyncLogDrain();
+		g_asyncLogFlushDone.store(flushRequest, std::memory_order_release);
+
+		if (!running)
+			return;
+		if (count == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+}
+
+} // namespace
+
+bool startAsyncLog(OnLog* sink, usize ringSize)
+{
+	MY_ASSERT(std::has_single_bit(ringSize) && ringSize >= 1024, false);
+
+	std::lock_guard guard(g_asyncLogMutex);
+	MY_ASSERT(!g_asyncLogRunning, false);
+
+	g_asyncLogSink = sink ? sink : asyncLogWriteStdout;
+	g_asyncLogPrevious = onLog;
+	g_asyncLogPreviousDeferred = onLogDeferred;
+	g_asyncLogRingSize = ringSize;
+	g_asyncLogRunning = true;
+	g_asyncLogThread.init(asyncLogRun);
+	onLog = asyncLogPush;
+	onLogDeferred = asyncLogPushDeferred;
+	return true;
+}
+
+void stopAsyncLog()
+{
+	{
+		std::lock_guard guard(g_asyncLogMutex);
+		if (!g_asyncLogRunning)
+			return;
+		onLog = g_asyncLogPrevious;
+		onLogDeferred = g_asyncLogPreviousDeferred;
+		g_asyncLogRunning = false;
+	}
+
+	// The consumer performs a final drain before exiting. Rings of live
+	// threads are retained for reuse.
+	g_asyncLogThread->join();
+	g_asyncLogThread.deinit();
+}
+
+void flushAsyncLog()
+{
+	if (!g_asyncLogRunning)
+		return;
+
+	// A concurrent stopAsyncLog may exit the consumer before it sees the
+	// request; its final drain then takes over.
+	u64 request = g_asyncLogFlushRequest.fetch_add(1, std::memory_order_acq_rel) + 1;
+	while (g_asyncLogFlushDone.load(std::memory_order_acquire) < request
+	    && g_asyncLogRunning.load(std::memory_order_acquire)) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
+
+u64 asyncLogDropCount()
+{
+	return g_asyncLogDropCount.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////
+// Log File
+
+namespace {
+
+constexpr char LogFileMagic[8] = {'M', 'Y', 'L', 'O', 'G', 'R', 'N', 'G'};
+constexpr u32 LogFileVersion = 1;
+
+// Placed at the start of the file. Positions increase monotonically; records
+// between tail and head are valid.
+struct LogFileHeader {
+	char magic[8] = {};
+	u32 version = 0;
+	u32 headerSize = 0;
+	u64 capacity = 0;
+	u64 head = 0;
+	u64 tail = 0;
+};
+
+constexpr usize LogFileHeaderSize = CacheLineSize;
+static_assert(sizeof(LogFileHeader) <= LogFileHeaderSize);
+
+// Followed by the file name and the message, both null-terminated. Only size
+// and flags are present for Skip records.
+struct LogFileRecord {
+	enum Flags : u32 {
+		Skip = 1 << 0, // marks unused space at the end of the ring
+	};
+
+	u32 size = 0; // including this header and padding
+	u32 flags = 0;
+	u8 severity = 0;
+	u8 reserved[3] = {};
+	u32 line = 0;
+	u32 fileSize = 0; // including terminator
+	u32 messageSize = 0; // including terminator
+	u64 time = 0;
+};
+
+constexpr usize LogFileSkipSize = 2 * sizeof(u32);
+constexpr usize LogFileMaxFileLength = 255;
+
+constinit std::mutex g_logFileMutex; // guards all of the below
+constinit u8* g_logFileMapping = nullptr;
+constinit usize g_logFileMappingSize = 0;
+
+LogFileHeader* logFileHeader()
+{
+	return reinterpret_cast<LogFileHeader*>(g_logFileMapping);
+}
+
+u8* logFileData()
+{
+	return g_logFileMapping + LogFileHeaderSize;
+}
+
+u8* logFileMap(const char* path, usize size)
+{
+#if defined _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+	    FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	MY_DEFER(CloseHandle(file));
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, DWORD(u64(size) >> 32), DWORD(size), nullptr);
+	if (!mapping)
+		return nullptr;
+	MY_DEFER(CloseHandle(mapping));
+
+	return static_cast<u8*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+#else
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return nullptr;
+	MY_DEFER(close(fd));
+
+	if (ftruncate(fd, off_t(size)) != 0)
+		return nullptr;
+
+	void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	return ptr == MAP_FAILED ? nullptr : static_cast<u8*>(ptr);
+#endif
+}
+
+void logFileUnmap(u8* ptr, usize size)
+{
+#if defined _WIN32
+	(void)size;
+	UnmapViewOfFile(ptr);
+#else
+	munmap(ptr, size);
+#endif
+}
+
+// Advances the tail until size bytes starting at head are free.
+void logFileMakeRoom(LogFileHeader* header, u64 head, usize size)
+{
+	u64 tail = header->tail;
+	while (head + size - tail > header->capacity) {
+		u32 recordSize;
+		memcpy(&recordSize, logFileData() + (tail & (header->capacity - 1)), sizeof(recordSize));
+		tail += recordSize;
+	}
+	header->tail = tail;
+
+	// The process may die at any point; the tail must not reference memory
+	// that is about to be overwritten.
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+} // namespace
+
+bool openLogFile(const char* path, usize size)
+{
+	MY_ASSERT(size >= 4096 && std::has_single_bit(size), false);
+
+	closeLogFile();
+
+	std::lock_guard guard(g_logFileMutex);
+	u8* mapping = logFileMap(path, LogFileHeaderSize + size);
+	if (!mapping)
+		return false;
+
+	g_logFileMapping = mapping;
+	g_logFileMappingSize = LogFileHeaderSize + size;
+
+	LogFileHeader* header = std::construct_at(logFileHeader());
+	memcpy(header->magic, LogFileMagic, sizeof(LogFileMagic));
+	header->version = LogFileVersion;
+	header->headerSize = LogFileHeaderSize;
+	header->capacity = size;
+	return true;
+}
+
+void closeLogFile()
+{
+	std::lock_guard guard(g_logFileMutex);
+	if (!g_logFileMapping)
+		return;
+
+	logFileUnmap(g_logFileMapping, g_logFileMappingSize);
+	g_logFileMapping = nullptr;
+	g_logFileMappingSize = 0;
+}
+
+void logFileSink(LogSeverity severity, const char* msg, const char* file, long line) noexcept
+{
+	auto now = std::chrono::system_clock::now().time_since_epoch();
+
+	std::lock_guard guard(g_logFileMutex);
+	LogFileHeader* header = logFileHeader();
+	if (!header)
+		return;
+
+	// Overly long messages are truncated to keep the ring usable.
+	usize fileLength = min(sLength(file), LogFileMaxFileLength);
+	usize messageLength = min(sLength(msg), usize(header->capacity / 4));
+	if (messageLength < sLength(msg)) {
+		g_logTruncationCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	usize size = alignUp(sizeof(LogFileRecord) + fileLength + 1 + messageLength + 1, alignof(LogFileRecord));
+
+	u64 mask = header->capacity - 1;
+	u64 head = header->head;
+	usize contiguous = usize(header->capacity - (head & mask));
+
+	if (contiguous < size) {
+		logFileMakeRoom(header, head, contiguous);
+		u32 skip[2] = {u32(contiguous), LogFileRecord::Skip};
+		memcpy(logFileData() + (head & mask), skip, LogFileSkipSize);
+		head += contiguous;
+	}
+
+	logFileMakeRoom(header, head, size);
+
+	u8* dst = logFileData() + (head & mask);
+	LogFileRecord record;
+	record.size = u32(size);
+	record.severity = u8(severity);
+	record.line = u32(line);
+	record.fileSize = u32(fileLength + 1);
+	record.messageSize = u32(messageLength + 1);
+	record.time = u64(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+	memcpy(dst, &record, sizeof(record));
+	dst += sizeof(record);
+	memcpy(dst, file, fileLength);
+	dst[fileLength] = '\0';
+	dst += fileLength + 1;
+	memcpy(dst, msg, messageLength);
+	dst[messageLength] = '\0';
+
+	// Publish the record only once it has been written completely.
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	header->head = head + size;
+}
+
+bool decodeLogFile(Span<const u8> image, OnLogFileEntry* onEntry, void* userdata)
+{
+	LogFileHeader header;
+	if (image.size < LogFileHeaderSize)
+		return false;
+	memcpy(&header, image.data, sizeof(header));
+
+	if (memcmp(header.magic, LogFileMagic, sizeof(LogFileMagic)) != 0 || header.version != LogFileVersion
+	    || header.headerSize != LogFileHeaderSize || header.capacity != image.size - LogFileHeaderSize
+	    || !std::has_single_bit(header.capacity) || header.head < header.tail
+	    || header.head - header.tail > header.capacity)
+		return false;
+
+	const u8* data = image.data + LogFileHeaderSize;
+	u64 mask = header.capacity - 1;
+
+	for (u64 pos = header.tail; pos < header.head;) {
+		usize offset = usize(pos & mask);
+		usize contiguous = usize(header.capacity - offset);
+		if (contiguous < LogFileSkipSize)
+			return false;
+
+		u32 prefix[2];
+		memcpy(prefix, data + offset, LogFileSkipSize);
+		if (prefix[0] < LogFileSkipSize || prefix[0] > contiguous || prefix[0] % alignof(LogFileRecord) != 0)
+			return false;
+		pos += prefix[0];
+
+		if (prefix[1] & LogFileRecord::Skip)
+			continue;
+		if (prefix[0] < sizeof(LogFileRecord))
+			return false;
+
+		LogFileRecord record;
+		memcpy(&record, data + offset, sizeof(record));
+		if (record.size < sizeof(record) + record.fileSize + record.messageSize || record.fileSize == 0
+		    || record.messageSize == 0 || record.severity > u8(LogSeverity::Error))
+			return false;
+
+		auto* file = reinterpret_cast<const char*>(data + offset + sizeof(record));
+		auto* message = file + record.fileSize;
+		if (file[record.fileSize - 1] != '\0' || message[record.messageSize - 1] != '\0')
+			return false;
+
+		LogFileEntry entry;
+		entry.time = record.time;
+		entry.severity = LogSeverity(record.severity);
+		entry.line = long(record.line);
+		entry.file = file;
+		entry.message = message;
+		onEntry(userdata, &entry);
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+// Allocator
+
+static void* allocAligned(usize size, usize alignment) noexcept
+{
+	MY_ASSERT(std::has_single_bit(alignment), nullptr);
+#if defined _WIN32
+	return _aligned_malloc(size, alignment);
+#else
+	if (alignment <= alignof(max_align_t))
+		return malloc(size);
+
+	// aligned_alloc requires size to be a multiple of alignment.
+	MY_ASSERT(size <= usize(-1) - alignment, nullptr);
+	return aligned_alloc(alignment, alignUp(size, alignment));
+#endif
+}
+
+static void deallocAligned(void* ptr) noexcept
+{
+#if defined _WIN32
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+constinit Allocator g_defaultAllocator(
+    +[](void*, usize size, usize alignment) noexcept { return allocAligned(size, alignment); },
+    +[](void*, void* ptr) noexcept { deallocAligned(ptr); }, nullptr);
+
+constinit Allocator g_cacheAlignedAllocator(
+    +[](void*, usize size, usize alignment) noexcept -> void* {
+	    if (size < HugePageSize)
+		    return allocAligned(size, max(alignment, CacheLineSize));
+
+	    void* ptr = allocAligned(size, max(alignment, HugePageSize));
+#if defined __linux__
+	    if (ptr) {
+		    madvise(ptr, alignUp(size, HugePageSize), MADV_HUGEPAGE);
+	    }
+#endif
+	    return ptr;
+    },
+    +[](void*, void* ptr) noexcept { deallocAligned(ptr); }, nullptr);
+
+////////////////////////////////////////////////////////////
+// Arena Allocator
+
+ArenaAllocator::ArenaAllocator(usize chunkSize, Allocator* backing)
+    : allocator_(
+          +[](void* arena, usize size, usize alignment) noexcept {
+	          return static_cast<ArenaAllocator*>(arena)->alloc(size, alignment);
+          },
+          +[](void*, void*) noexcept {}, this),
+      backing_(backing), chunkSize_(chunkSize)
+{
+}
+
+void* ArenaAllocator::alloc(usize size, usize alignment)
+{
+	MY_ASSERT(std::has_single_bit(alignment), nullptr);
+
+	Chunk* last = nullptr;
+	for (Chunk* chunk = current_ ? current_ : first_; chunk; chunk = chunk->next) {
+		auto base = uintptr_t(chunk->data());
+		usize offset = alignUp(base + chunk->used, alignment) - base;
+		if (offset <= chunk->size && size <= chunk->size - offset) {
+			chunk->used = offset + size;
+			current_ = chunk;
+			return chunk->data() + offset;
+		}
+		last = chunk;
+	}
+
+	MY_ASSERT(size <= usize(-1) - alignment - sizeof(Chunk), nullptr);
+	Chunk* chunk = newChunk_(max(chunkSize_, size + alignment - 1));
+	if (!chunk)
+		return nullptr;
+
+	if (last)
+		last->next = chunk;
+	else
+		first_ = chunk;
+	current_ = chunk;
+
+	auto base = uintptr_t(chunk->data());
+	usize offset = alignUp(base, alignment) - base;
+	chunk->used = offset + size;
+	return chunk->data() + offset;
+}
+
+void ArenaAllocator::rewind(Marker marker)
+{
+	Chunk* chunk = first_;
+	if (marker.chunk) {
+		MY_ASSERT(marker.used <= marker.chunk->used);
+		marker.chunk->used = marker.used;
+		chunk = marker.chunk->next;
+	}
+	for (; chunk; chunk = chunk->next) {
+		chunk->used = 0;
+	}
+	current_ = marker.chunk ? marker.chunk : first_;
+}
+
+void ArenaAllocator::release()
+{
+	Chunk* chunk = first_;
+	while (chunk) {
+		Chunk* next = chunk->next;
+		backing_->dealloc(chunk);
+		chunk = next;
+	}
+	first_ = nullptr;
+	current_ = nullptr;
+}
+
+usize ArenaAllocator::used() const
+{
+	usize used = 0;
+	for (Chunk* chunk = first_; chunk; chunk = chunk->next) {
+		used += chunk->used;
+	}
+	return used;
+}
+
+usize ArenaAllocator::reserved() const
+{
+	usize reserved = 0;
+	for (Chunk* chunk = first_; chunk; chunk = chunk->next) {
+		reserved += sizeof(Chunk) + chunk->size;
+	}
+	return reserved;
+}
+
+ArenaAllocator::Chunk* ArenaAllocator::newChunk_(usize size)
+{
+	void* ptr = backing_->alloc(sizeof(Chunk) + size, alignof(Chunk));
+	MY_ASSERT(ptr, nullptr);
+	return std::construct_at(static_cast<Chunk*>(ptr), Chunk{nullptr, size, 0});
+}
+
+////////////////////////////////////////////////////////////
+// Pool Allocator
+
+PoolAllocator::PoolAllocator(usize blockSize, usize blockAlignment, usize blocksPerSlab, Allocator* backing)
+    : allocator_(
+          +[](void* pool, usize size, usize alignment) noexcept -> void* {
+	          auto* self = static_cast<PoolAllocator*>(pool);
+	          MY_ASSERT(size <= self->blockSize_ && alignment <= self->blockAlignment_, nullptr);
+	          return self->alloc();
+          },
+          +[](void* pool, void* ptr) noexcept { static_cast<PoolAllocator*>(pool)->dealloc(ptr); }, this),
+      backing_(backing), blockAlignment_(max(blockAlignment, alignof(FreeBlock))), blocksPerSlab_(blocksPerSlab)
+{
+	MY_ASSERT(std::has_single_bit(blockAlignment));
+	MY_ASSERT(blocksPerSlab > 0);
+
+	// Blocks need to hold a free list link and keep subsequent blocks aligned.
+	blockSize_ = alignUp(max(blockSize, sizeof(FreeBlock)), blockAlignment_);
+}
+
+void* PoolAllocator::alloc()
+{
+	if (!freeList_) {
+		freeList_ = remoteFreeList_.exchange(nullptr, std::memory_order_acquire);
+	}
+
+	if (freeList_) {
+		FreeBlock* block = freeList_;
+		freeList_ = block->next;
+		return block;
+	}
+
+	if (bumpFirst_ == bumpLast_ && !newSlab_())
+		return nullptr;
+
+	void* block = bumpFirst_;
+	bumpFirst_ += blockSize_;
+	return block;
+}
+
+void PoolAllocator::dealloc(void* ptr)
+{
+	if (!ptr)
+		return;
+	freeList_ = std::construct_at(static_cast<FreeBlock*>(ptr), FreeBlock{freeList_});
+}
+
+void PoolAllocator::deallocRemote(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	// Push-only Treiber stack; the owner takes the whole list at once, hence
+	// no ABA problem can arise.
+	auto* block = std::construct_at(static_cast<FreeBlock*>(ptr), FreeBlock{});
+	block->next = remoteFreeList_.load(std::memory_order_relaxed);
+	while (!remoteFreeList_.compare_exchange_weak(block->next, block, std::memory_order_release,
+	    std::memory_order_relaxed)) {
+	}
+}
+
+void PoolAllocator::release()
+{
+	Slab* slab = slabs_;
+	while (slab) {
+		Slab* next = slab->next;
+		backing_->dealloc(slab);
+		slab = next;
+	}
+	slabs_ = nullptr;
+	freeList_ = nullptr;
+	bumpFirst_ = nullptr;
+	bumpLast_ = nullptr;
+	remoteFreeList_.store(nullptr, std::memory_order_relaxed);
+}
+
+bool PoolAllocator::newSlab_()
+{
+	usize headerSize = alignUp(sizeof(Slab), blockAlignment_);
+	MY_ASSERT(blocksPerSlab_ <= (usize(-1) - headerSize) / blockSize_, false);
+
+	void* ptr = backing_->alloc(headerSize + blockSize_ * blocksPerSlab_, max(blockAlignment_, alignof(Slab)));
+	MY_ASSERT(ptr, false);
+
+	slabs_ = std::construct_at(static_cast<Slab*>(ptr), Slab{slabs_});
+	bumpFirst_ = static_cast<u8*>(ptr) + headerSize;
+	bumpLast_ = bumpFirst_ + blockSize_ * blocksPerSlab_;
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+// Tracking Allocator
+
+constinit std::atomic<AllocationSite*> g_allocationSites = nullptr;
+constinit thread_local AllocationSite* g_allocationSite = nullptr;
+
+AllocationSiteScope::AllocationSiteScope(AllocationSite* site) : previous_(g_allocationSite)
+{
+	if (!site->registered_.exchange(true, std::memory_order_relaxed)) {
+		site->next_ = g_allocationSites.load(std::memory_order_relaxed);
+		while (!g_allocationSites.compare_exchange_weak(site->next_, site, std::memory_order_release,
+		    std::memory_order_relaxed)) {
+		}
+	}
+	g_allocationSite = site;
+}
+
+TrackingAllocator::TrackingAllocator(Allocator* backing)
+    : allocator_(
+          +[](void* tracker, usize size, usize alignment) noexcept {
+	          return static_cast<TrackingAllocator*>(tracker)->alloc(size, alignment);
+          },
+          +[](void* tracker, void* ptr) noexcept { static_cast<TrackingAllocator*>(tracker)->dealloc(ptr); }, this),
+      backing_(backing)
+{
+}
+
+void* TrackingAllocator::alloc(usize size, usize alignment)
+{
+	MY_ASSERT(std::has_single_bit(alignment), nullptr);
+
+	// The header is placed right in front of the returned pointer.
+	alignment = max(alignment, alignof(Header));
+	usize offset = alignUp(sizeof(Header), alignment);
+	MY_ASSERT(size <= usize(-1) - offset, nullptr);
+
+	auto* base = static_cast<u8*>(backing_->alloc(offset + size, alignment));
+	if (!base)
+		return nullptr;
+
+	u8* ptr = base + offset;
+	std::construct_at(reinterpret_cast<Header*>(ptr) - 1, Header{size, offset, g_allocationSite});
+
+	u64 live = liveBytes_.fetch_add(size, std::memory_order_relaxed) + size;
+	u64 peak = peakBytes_.load(std::memory_order_relaxed);
+	while (peak < live && !peakBytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+	}
+	allocCount_.fetch_add(1, std::memory_order_relaxed);
+	sizeClasses_[sizeClass(size)].fetch_add(1, std::memory_order_relaxed);
+
+	if (g_allocationSite) {
+		g_allocationSite->liveBytes.fetch_add(size, std::memory_order_relaxed);
+		g_allocationSite->allocCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return ptr;
+}
+
+void TrackingAllocator::dealloc(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	Header header = *(static_cast<Header*>(ptr) - 1);
+
+	liveBytes_.fetch_sub(header.size, std::memory_order_relaxed);
+	deallocCount_.fetch_add(1, std::memory_order_relaxed);
+	if (header.site) {
+		header.site->liveBytes.fetch_sub(header.size, std::memory_order_relaxed);
+	}
+
+	backing_->dealloc(static_cast<u8*>(ptr) - header.offset);
+}
+
+TrackingAllocator::Stats TrackingAllocator::snapshot() const
+{
+	Stats stats;
+	stats.liveBytes = liveBytes_.load(std::memory_order_relaxed);
+	stats.peakBytes = peakBytes_.load(std::memory_order_relaxed);
+	stats.allocCount = allocCount_.load(std::memory_order_relaxed);
+	stats.deallocCount = deallocCount_.load(std::memory_order_relaxed);
+	for (usize i = 0; i < SizeClassCount; i++) {
+		stats.sizeClasses[i] = sizeClasses_[i].load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+////////////////////////////////////////////////////////////
+// String Interner
+
+namespace {
+
+struct InternerLock {
+	explicit InternerLock(std::atomic<bool>* lock) : lock(lock)
+	{
+		while (lock->exchange(true, std::memory_order_acquire)) {
+			lock->wait(true, std::memory_order_relaxed);
+		}
+	}
+
+	~InternerLock()
+	{
+		lock->store(false, std::memory_order_release);
+		lock->notify_one();
+	}
+
+	std::atomic<bool>* lock;
+};
+
+u32 internerTag(u64 h) { return u32(h >> 32); }
+
+void internerInsert(StringInterner::Table* table, u64 h, u32 id)
+{
+	usize i = usize(h) & table->mask;
+	while (table->slots[i].load(std::memory_order_relaxed) != 0) {
+		i = (i + 1) & table->mask;
+	}
+	table->slots[i].store(u64(internerTag(h)) << 32 | (u64(id) + 1), std::memory_order_release);
+}
+
+} // namespace
+
+u32 StringInterner::find_(const Table* table, StringView s, u64 h) const
+{
+	if (!table)
+		return InvalidId;
+
+	for (usize i = usize(h) & table->mask;; i = (i + 1) & table->mask) {
+		u64 slot = table->slots[i].load(std::memory_order_acquire);
+		if (slot == 0)
+			return InvalidId;
+		if (u32(slot >> 32) != internerTag(h))
+			continue;
+
+		u32 id = u32(slot) - 1;
+		const Entry* entry = entry_(id);
+		if (entry->hash == h && entry->size == s.size && memcmp(entry + 1, s.data, s.size) == 0)
+			return id;
+	}
+}
+
+u32 StringInterner::find(StringView s) const
+{
+	u64 h = MY::hash(s);
+	return find_(table_.load(std::memory_order_acquire), s, h);
+}
+
+bool StringInterner::grow_()
+{
+	Table* old = table_.load(std::memory_order_relaxed);
+	usize capacity = old ? (old->mask + 1) * 2 : MinTableSize_;
+
+	Table* table = arena_.create<Table>();
+	MY_ASSERT(table, false);
+	auto* slots = static_cast<std::atomic<u64>*>(arena_.alloc(capacity * sizeof(std::atomic<u64>), alignof(u64)));
+	MY_ASSERT(slots, false);
+	for (usize i = 0; i < capacity; i++) {
+		std::construct_at(&slots[i], u64(0));
+	}
+	table->mask = capacity - 1;
+	table->slots = slots;
+
+	// Rehash from the entries, which carry their hash. The old table stays
+	// alive in the arena for readers still probing it.
+	u32 count = count_.load(std::memory_order_relaxed);
+	for (u32 id = 0; id < count; id++) {
+		internerInsert(table, entry_(id)->hash, id);
+	}
+
+	table_.store(table, std::memory_order_release);
+	return true;
+}
+
+u32 StringInterner::intern(StringView s)
+{
+	u64 h = MY::hash(s);
+	if (u32 id = find_(table_.load(std::memory_order_acquire), s, h); id != InvalidId)
+		return id;
+
+	InternerLock lock(&writeLock_);
+
+	// Another thread may have added s in the meantime.
+	Table* table = table_.load(std::memory_order_relaxed);
+	if (u32 id = find_(table, s, h); id != InvalidId)
+		return id;
+
+	u32 id = count_.load(std::memory_order_relaxed);
+	MY_ASSERT(id < InvalidId - 1, InvalidId);
+	MY_ASSERT(s.size < u32(-1), InvalidId);
+
+	// Keep the load factor at or below 3/4.
+	if (!table || (usize(id) + 1) * 4 > (table->mask + 1) * 3) {
+		if (!grow_())
+			return InvalidId; // already reported by grow_
+		table = table_.load(std::memory_order_relaxed);
+	}
+
+	usize segment, offset;
+	segmentOf_(id, &segment, &offset);
+	if (!segments_[segment]) {
+		usize entriesSize = (SegmentBaseSize_ << segment) * sizeof(Entry*);
+		auto* entries = static_cast<Entry**>(arena_.alloc(entriesSize, alignof(Entry*)));
+		MY_ASSERT(entries, InvalidId);
+		segments_[segment] = entries;
+	}
+
+	auto* entry = static_cast<Entry*>(arena_.alloc(sizeof(Entry) + s.size + 1, alignof(Entry)));
+	MY_ASSERT(entry, InvalidId);
+	std::construct_at(entry, Entry{h, u32(s.size)});
+	if (s.size > 0) {
+		memcpy(entry->data(), s.data, s.size);
+	}
+	entry->data()[s.size] = '\0';
+	segments_[segment][offset] = entry;
+
+	// Publishing the slot makes the entry visible to lock-free readers.
+	count_.store(id + 1, std::memory_order_release);
+	internerInsert(table, h, id);
+
+	return id;
+}
 
 } // namespace MY
@@ -25,7 +25,9 @@
 #include <math.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
+#include <atomic>
 #include <bit>
 #include <initializer_list>
 #include <memory>
@@ -96,6 +98,13 @@ overload(Ts...) -> overload<Ts...>;
 
 ////////////////////////////////////////////////////////////
 // Hash
+//
+// hash overloads for integers and pointers return the value unchanged. This is
+// cheap, but sequential IDs and aligned pointers (low bits always zero) cluster
+// badly when only some bits are used. hashMix scrambles all bits of a value.
+//
+// Containers take a hash policy: IdentityHash uses hash as is, MixedHash
+// additionally applies hashMix.
 
 // clang-format off
 inline constexpr u64 hash(i8  v) { return u64(v); }
@@ -116,34 +125,205 @@ constexpr u64 hash(T* p)
 	return u64(p);
 }
 
+inline constexpr u64 hashMix(u64 v)
+{
+	v ^= v >> 32u;
+	v *= 0xE9846AF9B1A615Du;
+	v ^= v >> 32u;
+	v *= 0xE9846AF9B1A615Du;
+	v ^= v >> 28u;
+	return v;
+}
+
 inline constexpr u64 hashCombine(u64 seed, u64 v)
 {
-	seed ^= seed >> 32u;
-	seed *= 0xE9846AF9B1A615Du;
-	seed ^= seed >> 32u;
-	seed *= 0xE9846AF9B1A615Du;
-	seed ^= seed >> 28u;
-	return seed + v;
+	return hashMix(seed) + v;
+}
+
+struct IdentityHash {
+	template <typename T>
+	constexpr u64 operator()(const T& v) const
+	{
+		return hash(v);
+	}
+};
+
+struct MixedHash {
+	template <typename T>
+	constexpr u64 operator()(const T& v) const
+	{
+		return hashMix(hash(v));
+	}
+};
+
+// Bulk hashing follows the design of wyhash: input is consumed in 48 byte
+// blocks by three independent lanes, each folding 16 bytes per step through a
+// 64x64->128 bit multiply. The lanes are independent, hence the CPU can
+// overlap their multiplications. Inputs up to 16 bytes are handled with a few
+// overlapping loads, without loops.
+//
+// Loads are unaligned-safe (memcpy at run-time) and the whole function remains
+// usable in constant evaluation. Results are identical on every platform.
+
+inline constexpr u64 HashSecret_[4] = {
+    0xA0761D6478BD642Fu, 0xE7037ED1A0B428DBu, 0x8EBC6AF09C88C6E3u, 0x589965CC75374CC3u};
+
+// Computes the full 128 bit product of a and b, returning the low half in a and
+// the high half in b.
+inline constexpr void hashMul128_(u64* a, u64* b)
+{
+#if defined __SIZEOF_INT128__
+	__extension__ using u128 = unsigned __int128;
+	u128 r = u128(*a) * u128(*b);
+	*a = u64(r);
+	*b = u64(r >> 64u);
+#else
+	u64 ha = *a >> 32u, hb = *b >> 32u, la = u32(*a), lb = u32(*b);
+	u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	u64 t = rl + (rm0 << 32u);
+	u64 c = t < rl;
+	u64 lo = t + (rm1 << 32u);
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32u) + (rm1 >> 32u) + c;
+#endif
+}
+
+inline constexpr u64 hashMix_(u64 a, u64 b)
+{
+	hashMul128_(&a, &b);
+	return a ^ b;
+}
+
+template <typename Byte>
+constexpr u64 hashLoad_(const Byte* p, usize n)
+{
+	if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+		u64 v = 0;
+		memcpy(&v, p, n);
+		return v;
+	}
+	u64 v = 0;
+	for (usize i = 0; i < n; i++) {
+		v |= u64(u8(p[i])) << (8u * i);
+	}
+	return v;
+}
+
+template <typename Byte>
+constexpr u64 hashLoad64_(const Byte* p)
+{
+	return hashLoad_(p, 8);
+}
+
+template <typename Byte>
+constexpr u64 hashLoad32_(const Byte* p)
+{
+	return hashLoad_(p, 4);
+}
+
+inline constexpr u64 hashSeed_(u64 seed)
+{
+	return seed ^ hashMix_(seed ^ HashSecret_[0], HashSecret_[1]);
+}
+
+template <typename Byte>
+constexpr void hashBlock48_(const Byte* p, u64* seed, u64* seed1, u64* seed2)
+{
+	const u64* s = HashSecret_;
+	*seed = hashMix_(hashLoad64_(p) ^ s[1], hashLoad64_(p + 8) ^ *seed);
+	*seed1 = hashMix_(hashLoad64_(p + 16) ^ s[2], hashLoad64_(p + 24) ^ *seed1);
+	*seed2 = hashMix_(hashLoad64_(p + 32) ^ s[3], hashLoad64_(p + 40) ^ *seed2);
 }
 
-inline constexpr u64 hashRange(const u8* data, usize size)
+// Processes the remaining i bytes at p, yielding the final state a, b. For
+// inputs larger than 16 bytes, the 16 bytes in front of p + i need to be
+// readable, even if they precede p.
+template <typename Byte>
+constexpr void hashTail_(const Byte* p, usize i, u64 seed, usize size, u64* outA, u64* outB)
 {
-	u64 seed = 0;
-	while (size >= sizeof(u64)) {
-		seed = hashCombine(seed, *reinterpret_cast<const u64*>(data));
-		data += sizeof(u64);
-		size -= sizeof(u64);
+	const u64* s = HashSecret_;
+
+	u64 a = 0;
+	u64 b = 0;
+	if (size <= 16) {
+		if (size >= 4) {
+			usize mid = (size >> 3u) << 2u;
+			a = (hashLoad32_(p) << 32u) | hashLoad32_(p + mid);
+			b = (hashLoad32_(p + size - 4) << 32u) | hashLoad32_(p + size - 4 - mid);
+		}
+		else if (size > 0) {
+			a = (u64(u8(p[0])) << 16u) | (u64(u8(p[size >> 1u])) << 8u) | u64(u8(p[size - 1]));
+		}
 	}
-	while (size >= sizeof(u32)) {
-		seed = hashCombine(seed, *reinterpret_cast<const u32*>(data));
-		data += sizeof(u32);
-		size -= sizeof(u32);
+	else {
+		while (i > 16) {
+			seed = hashMix_(hashLoad64_(p) ^ s[1], hashLoad64_(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = hashLoad64_(p + i - 16);
+		b = hashLoad64_(p + i - 8);
 	}
-	while (size > 0) {
-		seed = hashCombine(seed, *data++);
-		size--;
+
+	a ^= s[1];
+	b ^= seed;
+	hashMul128_(&a, &b);
+	*outA = a;
+	*outB = b;
+}
+
+template <typename Byte>
+constexpr void hashBytes_(const Byte* p, usize size, u64 seed, u64* outA, u64* outB)
+{
+	seed = hashSeed_(seed);
+
+	usize i = size;
+	if (i > 48) {
+		u64 seed1 = seed;
+		u64 seed2 = seed;
+		do {
+			hashBlock48_(p, &seed, &seed1, &seed2);
+			p += 48;
+			i -= 48;
+		} while (i > 48);
+		seed ^= seed1 ^ seed2;
 	}
-	return seed;
+
+	hashTail_(p, i, seed, size, outA, outB);
+}
+
+// A second output is derived from the final state using different secrets,
+// yielding a 128 bit hash at virtually no extra cost.
+struct Hash128 {
+	friend constexpr bool operator==(const Hash128&, const Hash128&) = default;
+
+	u64 low = 0;
+	u64 high = 0;
+};
+
+inline constexpr u64 hashFinal64_(u64 a, u64 b, usize size)
+{
+	return hashMix_(a ^ HashSecret_[0] ^ size, b ^ HashSecret_[1]);
+}
+
+inline constexpr Hash128 hashFinal128_(u64 a, u64 b, usize size)
+{
+	return {hashFinal64_(a, b, size), hashMix_(a ^ HashSecret_[2] ^ size, b ^ HashSecret_[3])};
+}
+
+inline constexpr u64 hashRange(const u8* data, usize size, u64 seed = 0)
+{
+	u64 a = 0, b = 0;
+	hashBytes_(data, size, seed, &a, &b);
+	return hashFinal64_(a, b, size);
+}
+
+inline constexpr Hash128 hashRange128(const u8* data, usize size, u64 seed = 0)
+{
+	u64 a = 0, b = 0;
+	hashBytes_(data, size, seed, &a, &b);
+	return hashFinal128_(a, b, size);
 }
 
 ////////////////////////////////////////////////////////////
@@ -204,28 +384,162 @@ extern OnAssert* onAssert;
 //
 // The Trace severity is meant for sub-system specific logging that can be
 // enabled / disabled at compile-time via the preprocessor (e.g. MY_TRACE_INPUT,
-// MY_TRACE_AUDIO).
+// MY_TRACE_AUDIO). Alternatively, a LogChannel per sub-system can be toggled
+// at run-time:
+//
+//     constinit LogChannel g_traceInput{"Input"};
+//     #define MY_TRACE_INPUT(...) MY_TRACE(g_traceInput, __VA_ARGS__)
+//
+// Messages below MY_LOG_MIN_SEVERITY (numeric value of LogSeverity) are
+// removed at compile-time. Messages below g_logMinSeverity are dropped at
+// run-time, before formatting.
+//
+// Messages longer than MY_LOG_BUFFER_SIZE are formatted into a thread-local,
+// arena-backed scratch buffer of up to LogSpillMaxSize bytes instead. Only
+// messages exceeding that limit are truncated, see logTruncationCount. This
+// also holds for rate-limited, deferred, and structured messages passed to
+// onLog. Sinks may impose lower limits, see Async Logging and Log File.
 //
 // Note that onLog's implementation as to cover thread-safety.
 
+#ifndef MY_LOG_MIN_SEVERITY
+#define MY_LOG_MIN_SEVERITY 0
+#endif
+
+#if MY_LOG_MIN_SEVERITY <= 0
+#define MY_TRACE(channel, ...) \
+	do { \
+		if ((channel).enabled.load(std::memory_order_relaxed)) { \
+			MY_LOG(::MY::LogSeverity::Trace, __VA_ARGS__); \
+		} \
+	} while (0)
+#else
+#define MY_TRACE(channel, ...) \
+	do { \
+	} while (0)
+#endif
+
+#if MY_LOG_MIN_SEVERITY <= 1
 #define MY_INFO(...) MY_LOG(::MY::LogSeverity::Info, __VA_ARGS__)
+#else
+#define MY_INFO(...) \
+	do { \
+	} while (0)
+#endif
+
+#if MY_LOG_MIN_SEVERITY <= 2
 #define MY_WARN(...) MY_LOG(::MY::LogSeverity::Warning, __VA_ARGS__)
+#else
+#define MY_WARN(...) \
+	do { \
+	} while (0)
+#endif
+
 #define MY_ERROR(...) MY_LOG(::MY::LogSeverity::Error, __VA_ARGS__)
 
 // To minimize dynamic allocation, a thread-local buffer is used for formatting.
 #define MY_LOG_BUFFER_SIZE 1024
 extern thread_local char g_logBuffer[MY_LOG_BUFFER_SIZE];
 
+constexpr usize LogSpillMaxSize = 1024 * 1024;
+
 #define MY_LOG(severity, ...) \
 	do { \
-		if (::MY::onLog) { \
-			::MY::sFormat(::MY::g_logBuffer, __VA_ARGS__); \
-			::MY::onLog(severity, ::MY::g_logBuffer, MY_FILENAME, __LINE__); \
+		if (::MY::logEnabled(severity) && ::MY::onLog) { \
+			const char* MY_logMessage = ::MY::formatLogMessage_(__VA_ARGS__); \
+			::MY::onLog(severity, MY_logMessage, MY_FILENAME, __LINE__); \
 		} \
 	} while (0)
 
+// Returns g_logBuffer or the spill buffer, valid until the next call.
+MY_ATTR_PRINTF(1, 2)
+const char* formatLogMessage_(MY_ATTR_PRINTF_PARAM(const char* fmt), ...);
+
+// Number of log messages truncated due to exceeding LogSpillMaxSize.
+u64 logTruncationCount();
+
 enum class LogSeverity { Trace, Info, Warning, Error };
 
+extern std::atomic<LogSeverity> g_logMinSeverity;
+
+inline bool logEnabled(LogSeverity severity)
+{
+	return int(severity) >= MY_LOG_MIN_SEVERITY && severity >= g_logMinSeverity.load(std::memory_order_relaxed);
+}
+
+struct LogChannel {
+	const char* name = nullptr;
+	std::atomic<bool> enabled = false;
+};
+
+////////////////////////////////////////////////////////////
+// Rate-limited Logging
+//
+// These macros protect sinks from log storms caused by hot paths. Each
+// call-site keeps its own LogLimiter in a static variable; no allocation takes
+// place.
+//
+// - MY_LOG_EVERY_N emits the 1st, (n+1)th, (2n+1)th, ... message; n = 0 is
+//   treated like n = 1
+// - MY_LOG_EVERY_MS emits at most one message per interval
+// - MY_LOG_ONCE emits only the first message
+//
+// The number of messages suppressed since the last emitted one is appended.
+
+#define MY_LOG_EVERY_N(n, severity, ...) MY_LOG_LIMITED_(severity, everyN(n, &MY_logSuppressed), __VA_ARGS__)
+#define MY_LOG_EVERY_MS(ms, severity, ...) MY_LOG_LIMITED_(severity, everyMs(ms, &MY_logSuppressed), __VA_ARGS__)
+#define MY_LOG_ONCE(severity, ...) MY_LOG_LIMITED_(severity, once(&MY_logSuppressed), __VA_ARGS__)
+
+#define MY_LOG_LIMITED_(severity, check, ...) \
+	do { \
+		static constinit ::MY::LogLimiter MY_logLimiter; \
+		::MY::u64 MY_logSuppressed = 0; \
+		if (::MY::logEnabled(severity) && ::MY::onLog && MY_logLimiter.check) { \
+			const char* MY_logMessage = ::MY::formatLogMessage_(__VA_ARGS__); \
+			MY_logMessage = ::MY::appendSuppressedCount_(MY_logMessage, MY_logSuppressed); \
+			::MY::onLog(severity, MY_logMessage, MY_FILENAME, __LINE__); \
+		} \
+	} while (0)
+
+// Monotonic time in milliseconds.
+u64 logTimeMs_();
+
+// Returns msg, as returned by formatLogMessage_, with the suppressed count
+// appended.
+const char* appendSuppressedCount_(const char* msg, u64 suppressed);
+
+struct LogLimiter {
+	bool everyN(u64 n, u64* suppressed)
+	{
+		u64 count = count_.fetch_add(1, std::memory_order_relaxed);
+		if (n > 1 && count % n != 0)
+			return false;
+		*suppressed = count == 0 || n == 0 ? 0 : n - 1;
+		return true;
+	}
+
+	bool everyMs(u64 ms, u64* suppressed)
+	{
+		u64 now = logTimeMs_();
+		u64 next = next_.load(std::memory_order_relaxed);
+		if (now < next || !next_.compare_exchange_strong(next, now + ms, std::memory_order_relaxed)) {
+			count_.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		*suppressed = count_.exchange(0, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool once(u64* suppressed)
+	{
+		*suppressed = 0;
+		return count_.fetch_add(1, std::memory_order_relaxed) == 0;
+	}
+
+	std::atomic<u64> count_ = 0;
+	std::atomic<u64> next_ = 0;
+};
+
 inline constexpr char toChar(LogSeverity severity)
 {
 	switch (severity) {
@@ -240,6 +554,68 @@ inline constexpr char toChar(LogSeverity severity)
 using OnLog = void(LogSeverity, const char* message, const char* file, long line) noexcept;
 extern OnLog* onLog;
 
+////////////////////////////////////////////////////////////
+// Async Logging
+//
+// Decouples log producers from the (slow) sink. While active, onLog and
+// onLogDeferred push records into a per-thread single-producer /
+// single-consumer ring buffer and return immediately. Deferred records are
+// formatted on the consumer thread. A background thread drains all rings in
+// batches and forwards the records to the sink.
+//
+// Producers never block: if a ring is full, the record is dropped and counted.
+// Records longer than a quarter of the ring are truncated, see
+// logTruncationCount. Without a sink, records are written to stdout, flushed
+// once per batch.
+//
+// flushAsyncLog waits until records logged by the calling thread have been
+// handed to the sink. stopAsyncLog drains all rings and restores the previous
+// onLog / onLogDeferred.
+
+constexpr usize AsyncLogDefaultRingSize = 64 * 1024;
+
+bool startAsyncLog(OnLog* sink = nullptr, usize ringSize = AsyncLogDefaultRingSize);
+void stopAsyncLog();
+void flushAsyncLog();
+
+u64 asyncLogDropCount();
+
+////////////////////////////////////////////////////////////
+// Log File
+//
+// A sink writing records into a memory-mapped ring file of fixed size. Logging
+// boils down to plain memory stores; the kernel writes dirty pages back, hence
+// the most recent records survive a crash of the process. Once the ring is
+// full, the oldest records are overwritten. Messages longer than a quarter of
+// the ring are truncated, see logTruncationCount.
+//
+// logFileSink is an OnLog; assign it to onLog or pass it to startAsyncLog. It
+// does nothing while no log file is open. Opening truncates an existing file.
+//
+// decodeLogFile walks the records of a file image, oldest first. See
+// tools/log_decode.cpp for a command-line decoder.
+
+constexpr usize LogFileDefaultSize = 4 * 1024 * 1024;
+
+struct LogFileEntry {
+	u64 time = 0; // nanoseconds since the Unix epoch
+	LogSeverity severity = LogSeverity::Info;
+	long line = 0;
+	const char* file = nullptr;
+	const char* message = nullptr;
+};
+
+using OnLogFileEntry = void(void* userdata, const LogFileEntry* entry);
+
+// Size of the ring must be a power of 2 and at least 4 KiB.
+bool openLogFile(const char* path, usize size = LogFileDefaultSize);
+void closeLogFile();
+
+void logFileSink(LogSeverity severity, const char* msg, const char* file, long line) noexcept;
+
+// Returns false if image is not a valid log file.
+bool decodeLogFile(Span<const u8> image, OnLogFileEntry* onEntry, void* userdata = nullptr);
+
 ////////////////////////////////////////////////////////////
 // Defer
 //
@@ -537,19 +913,183 @@ struct Span {
 	usize size = 0;
 };
 
+// Spans of single-byte integers (char, u8) are hashed without reinterpreting
+// the data, hence they remain usable in constant evaluation.
+template <typename T>
+inline constexpr u64 hash(Span<T> span, u64 seed = 0)
+{
+	if constexpr (std::is_integral_v<T> && sizeof(T) == 1) {
+		u64 a = 0, b = 0;
+		hashBytes_(span.data, span.size, seed, &a, &b);
+		return hashFinal64_(a, b, span.size);
+	}
+	else {
+		auto bytes = span.template as<const u8>();
+		return hashRange(bytes.data, bytes.size, seed);
+	}
+}
+
+template <typename T>
+inline constexpr Hash128 hash128(Span<T> span, u64 seed = 0)
+{
+	if constexpr (std::is_integral_v<T> && sizeof(T) == 1) {
+		u64 a = 0, b = 0;
+		hashBytes_(span.data, span.size, seed, &a, &b);
+		return hashFinal128_(a, b, span.size);
+	}
+	else {
+		auto bytes = span.template as<const u8>();
+		return hashRange128(bytes.data, bytes.size, seed);
+	}
+}
+
+// Fills out with independent hashes of span from a single pass, as needed by
+// Bloom filters and count-min sketches. Hashes are derived from a 128 bit hash
+// via double hashing (h1 + i * h2, Kirsch-Mitzenmacher); h2 is odd, hence
+// indices cycle through all slots of power-of-two sized tables.
 template <typename T>
-inline constexpr u64 hash(Span<T> span)
+inline constexpr void hashN(Span<T> span, Span<u64> out, u64 seed = 0)
 {
-	auto bytes = span.template as<u8>();
-	return hashRange(bytes.data, bytes.size);
+	Hash128 h = hash128(span, seed);
+	u64 h2 = h.high | 1u;
+	for (usize i = 0; i < out.size; i++) {
+		out.data[i] = h.low + u64(i) * h2;
+	}
 }
 
+////////////////////////////////////////////////////////////
+// Hasher
+//
+// Incrementally hashes input provided in chunks. The result is identical to
+// hashing the concatenated input via hashRange.
+//
+// Full 48 byte blocks are hashed straight from the given chunks; only partial
+// blocks are buffered.
+
+struct Hasher {
+	constexpr explicit Hasher(u64 seed = 0) : seed_(hashSeed_(seed)) {}
+
+	void update(Span<const u8> data)
+	{
+		const u8* p = data.data;
+		usize n = data.size;
+		if (n == 0)
+			return;
+		size_ += n;
+
+		if (pending_ > 0) {
+			usize take = min(48 - pending_, n);
+			memcpy(buffer_ + pending_, p, take);
+			pending_ += take;
+			p += take;
+			n -= take;
+
+			// A block is only hashed once more input follows.
+			if (n == 0)
+				return;
+			hashBlock_(buffer_);
+			pending_ = 0;
+		}
+
+		const u8* block = nullptr;
+		while (n > 48) {
+			block = p;
+			hashBlock_(p);
+			p += 48;
+			n -= 48;
+		}
+		if (block) {
+			memcpy(previous_, block + 32, 16);
+		}
+
+		memcpy(buffer_, p, n);
+		pending_ = n;
+	}
+
+	template <typename T>
+	void update(Span<T> data)
+	{
+		update(data.template as<const u8>());
+	}
+
+	u64 finalize() const
+	{
+		u64 a = 0, b = 0;
+		finalState_(&a, &b);
+		return hashFinal64_(a, b, size_);
+	}
+
+	Hash128 finalize128() const
+	{
+		u64 a = 0, b = 0;
+		finalState_(&a, &b);
+		return hashFinal128_(a, b, size_);
+	}
+
+	void finalState_(u64* outA, u64* outB) const
+	{
+		u64 seed = seed_;
+		if (blocks_) {
+			seed ^= seed1_ ^ seed2_;
+		}
+
+		// The tail may look back up to 16 bytes into the previous block.
+		u8 tail[16 + 48];
+		memcpy(tail, previous_, 16);
+		memcpy(tail + 16, buffer_, pending_);
+		hashTail_(tail + 16, pending_, seed, size_, outA, outB);
+	}
+
+	void hashBlock_(const u8* p)
+	{
+		if (!blocks_) {
+			seed1_ = seed_;
+			seed2_ = seed_;
+			blocks_ = true;
+		}
+		hashBlock48_(p, &seed_, &seed1_, &seed2_);
+		if (p == buffer_) {
+			memcpy(previous_, buffer_ + 32, 16);
+		}
+	}
+
+	u64 seed_ = 0;
+	u64 seed1_ = 0;
+	u64 seed2_ = 0;
+	bool blocks_ = false;
+	usize size_ = 0;
+	usize pending_ = 0;
+	u8 buffer_[48] = {};
+	u8 previous_[16] = {};
+};
+
 ////////////////////////////////////////////////////////////
 // Memory Utils
+//
+// Relocation moves objects into uninitialized memory, destroying the source
+// objects. Trivially relocatable types are relocated via memmove, skipping
+// per-element move construction and destruction. Specialize
+// TriviallyRelocatable for types known to be safe (e.g. types holding a unique
+// pointer).
+
+inline constexpr usize alignUp(usize v, usize alignment)
+{
+	return (v + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+constexpr bool TriviallyRelocatable = std::is_trivially_copyable_v<T>;
 
 template <typename T>
 T* relocateUninit(T* first, T* last, T* dstFirst)
 {
+	if constexpr (TriviallyRelocatable<T>) {
+		if (first != last) {
+			memmove(static_cast<void*>(dstFirst), static_cast<const void*>(first), sizeof(T) * usize(last - first));
+		}
+		return dstFirst + (last - first);
+	}
+
 	while (first != last) {
 		std::construct_at(dstFirst, std::move(*first));
 		std::destroy_at(first);
@@ -562,6 +1102,14 @@ T* relocateUninit(T* first, T* last, T* dstFirst)
 template <typename T>
 T* relocateUninitBackward(T* first, T* last, T* dstLast)
 {
+	if constexpr (TriviallyRelocatable<T>) {
+		T* dstFirst = dstLast - (last - first);
+		if (first != last) {
+			memmove(static_cast<void*>(dstFirst), static_cast<const void*>(first), sizeof(T) * usize(last - first));
+		}
+		return dstFirst;
+	}
+
 	while (first != last) {
 		last--;
 		dstLast--;
@@ -573,6 +1121,18 @@ T* relocateUninitBackward(T* first, T* last, T* dstLast)
 
 ////////////////////////////////////////////////////////////
 // Allocator
+//
+// An Allocator is a type-erased memory resource. Alignments need to be a power
+// of two.
+//
+// g_defaultAllocator is backed by malloc / aligned_alloc and honors arbitrary
+// alignment. g_cacheAlignedAllocator aligns every allocation to at least
+// CacheLineSize to avoid false sharing. Allocations of HugePageSize or more are
+// aligned to HugePageSize and, where supported, backed by transparent huge
+// pages.
+
+constexpr usize CacheLineSize = 64;
+constexpr usize HugePageSize = 2 * 1024 * 1024;
 
 struct Allocator {
 	using OnAlloc = void*(void* userdata, usize size, usize alignment) noexcept;
@@ -592,63 +1152,290 @@ struct Allocator {
 };
 
 extern Allocator g_defaultAllocator;
+extern Allocator g_cacheAlignedAllocator;
 
 ////////////////////////////////////////////////////////////
-// Fixed Vector
+// Arena Allocator
 //
-// Note on constexpr: it's impossible to use FixedVector in a constexpr context
-// as reinterpret_cast is not allowed in a constexpr context. reinterpret_cast
-// is essential for the implementation.
+// A linear allocator that serves allocations by bumping an offset inside large
+// chunks, which are obtained from a backing Allocator and chained together.
+// Individual deallocation is a no-op; instead, memory is reclaimed all at once
+// via reset, or up to a previously taken marker via rewind:
+//
+//     auto marker = arena.marker();
+//     MY_DEFER(arena.rewind(marker));
+//
+// Chunks are retained on reset / rewind for reuse and only returned to the
+// backing allocator on release. Objects placed in the arena are not destroyed.
+//
+// allocator() provides an Allocator view, which can be handed to containers.
 
-template <typename T, usize Capacity>
-struct FixedVector {
-	FixedVector() noexcept = default;
-	FixedVector(Span<T> span) { assignSpan(span); }
-	FixedVector(Span<const T> span) { assignSpan(span); }
-	FixedVector(std::initializer_list<T> init) { assignRange(init.begin(), init.end()); }
+struct ArenaAllocator {
+	struct Chunk {
+		Chunk* next = nullptr;
+		usize size = 0;
+		usize used = 0;
 
-	~FixedVector() noexcept { clear(); }
+		u8* data() { return reinterpret_cast<u8*>(this + 1); }
+	};
 
-	FixedVector(const FixedVector& other)
-	    requires(std::is_copy_constructible_v<T>)
-	{
-		std::uninitialized_copy(other.begin(), other.end(), begin());
-		size_ = other.size_;
-	}
+	struct Marker {
+		Chunk* chunk = nullptr;
+		usize used = 0;
+	};
 
-	FixedVector& operator=(const FixedVector& other)
-	    requires(std::is_copy_constructible_v<T>)
-	{
-		if (&other != this) {
-			clear();
-			std::uninitialized_copy(other.begin(), other.end(), begin());
-			size_ = other.size_;
-		}
-		return *this;
-	}
+	static constexpr usize DefaultChunkSize = 64 * 1024;
 
-	FixedVector(FixedVector&& other) noexcept
-	    requires(std::is_nothrow_move_constructible_v<T>)
-	{
-		std::uninitialized_move(other.begin(), other.end(), begin());
-		size_ = other.size_;
-		other.clear();
-	}
+	explicit ArenaAllocator(usize chunkSize = DefaultChunkSize, Allocator* backing = &g_defaultAllocator);
+	~ArenaAllocator() noexcept { release(); }
 
-	FixedVector& operator=(FixedVector&& other) noexcept
-	    requires(std::is_nothrow_move_constructible_v<T>)
+	ArenaAllocator(const ArenaAllocator&) = delete;
+	ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+	void* alloc(usize size, usize alignment = 1);
+
+	template <typename T, typename... Args>
+	T* create(Args&&... args)
 	{
-		if (&other != this) {
-			clear();
-			std::uninitialized_move(other.begin(), other.end(), begin());
-			size_ = other.size_;
-			other.clear();
-		}
-		return *this;
+		void* ptr = alloc(sizeof(T), alignof(T));
+		MY_ASSERT(ptr, nullptr);
+		return std::construct_at(static_cast<T*>(ptr), std::forward<Args>(args)...);
 	}
 
-	usize size() const { return size_; }
-	usize sizeBytes() const { return sizeof(T) * size_; }
+	Marker marker() const { return {current_, current_ ? current_->used : 0}; }
+	void rewind(Marker marker);
+
+	// Rewinds to the beginning, retaining all chunks.
+	void reset() { rewind({}); }
+
+	// Returns all chunks to the backing allocator.
+	void release();
+
+	Allocator* allocator() { return &allocator_; }
+
+	// Number of bytes handed out since the last reset, including padding.
+	usize used() const;
+
+	// Number of bytes obtained from the backing allocator.
+	usize reserved() const;
+
+	Chunk* newChunk_(usize size);
+
+	Allocator allocator_;
+	Allocator* backing_ = nullptr;
+	usize chunkSize_ = 0;
+	Chunk* first_ = nullptr;
+	Chunk* current_ = nullptr;
+};
+
+////////////////////////////////////////////////////////////
+// Pool Allocator
+//
+// Serves fixed-size blocks carved from large slabs, which are obtained from a
+// backing Allocator. Freed blocks are kept in an intrusive free list, hence
+// alloc and dealloc are O(1).
+//
+// alloc and dealloc must be called from the owning thread. Other threads may
+// return blocks via deallocRemote, which pushes onto a separate lock-free list.
+// The owning thread takes over this list once its own free list is exhausted.
+//
+// allocator() provides an Allocator view, which can be handed to containers.
+// Requests exceeding the block size or alignment fail.
+
+struct PoolAllocator {
+	struct FreeBlock {
+		FreeBlock* next = nullptr;
+	};
+
+	struct Slab {
+		Slab* next = nullptr;
+	};
+
+	static constexpr usize DefaultBlocksPerSlab = 256;
+
+	PoolAllocator(usize blockSize, usize blockAlignment = alignof(max_align_t),
+	    usize blocksPerSlab = DefaultBlocksPerSlab, Allocator* backing = &g_defaultAllocator);
+	~PoolAllocator() noexcept { release(); }
+
+	PoolAllocator(const PoolAllocator&) = delete;
+	PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+	void* alloc();
+	void dealloc(void* ptr);
+	void deallocRemote(void* ptr);
+
+	// Returns all slabs to the backing allocator. Outstanding blocks become
+	// invalid.
+	void release();
+
+	Allocator* allocator() { return &allocator_; }
+
+	usize blockSize() const { return blockSize_; }
+	usize blockAlignment() const { return blockAlignment_; }
+
+	bool newSlab_();
+
+	Allocator allocator_;
+	Allocator* backing_ = nullptr;
+	usize blockSize_ = 0;
+	usize blockAlignment_ = 0;
+	usize blocksPerSlab_ = 0;
+
+	Slab* slabs_ = nullptr;
+	FreeBlock* freeList_ = nullptr;
+	u8* bumpFirst_ = nullptr;
+	u8* bumpLast_ = nullptr;
+
+	std::atomic<FreeBlock*> remoteFreeList_ = nullptr;
+};
+
+////////////////////////////////////////////////////////////
+// Tracking Allocator
+//
+// Wraps a backing Allocator and records statistics: live and peak bytes,
+// allocation / deallocation counts, and a histogram of power-of-two size
+// classes. Counters are updated atomically; snapshot copies them.
+//
+// Allocations can be attributed to call-sites by placing MY_ALLOCATION_SITE()
+// in a scope. All allocations made through a TrackingAllocator on the current
+// thread within that scope are accounted to the site. Sites register
+// themselves on first use and can be enumerated via g_allocationSites.
+//
+// A small header is placed in front of each allocation to remember its size.
+
+#define MY_ALLOCATION_SITE() MY_ALLOCATION_SITE_(MY_TEMPORARY(MY_allocationSite))
+#define MY_ALLOCATION_SITE_(name) \
+	static constinit ::MY::AllocationSite name(MY_FILENAME, __LINE__); \
+	const ::MY::AllocationSiteScope MY_XCONCAT(name, Scope)(&name)
+
+struct AllocationSite {
+	constexpr AllocationSite(const char* file, long line) : file(file), line(line) {}
+
+	const char* file = nullptr;
+	long line = 0;
+	std::atomic<u64> liveBytes = 0;
+	std::atomic<u64> allocCount = 0;
+
+	std::atomic<bool> registered_ = false;
+	AllocationSite* next_ = nullptr;
+};
+
+extern std::atomic<AllocationSite*> g_allocationSites;
+extern thread_local AllocationSite* g_allocationSite;
+
+struct AllocationSiteScope {
+	explicit AllocationSiteScope(AllocationSite* site);
+	~AllocationSiteScope() noexcept { g_allocationSite = previous_; }
+
+	AllocationSiteScope(const AllocationSiteScope&) = delete;
+	AllocationSiteScope& operator=(const AllocationSiteScope&) = delete;
+
+	AllocationSite* previous_ = nullptr;
+};
+
+struct TrackingAllocator {
+	// Size class i covers sizes up to 16 << i, the last one covers the rest.
+	static constexpr usize SizeClassCount = 20;
+
+	struct Stats {
+		u64 liveBytes = 0;
+		u64 peakBytes = 0;
+		u64 allocCount = 0;
+		u64 deallocCount = 0;
+		u64 sizeClasses[SizeClassCount] = {};
+	};
+
+	struct Header {
+		usize size = 0;
+		usize offset = 0;
+		AllocationSite* site = nullptr;
+	};
+
+	explicit TrackingAllocator(Allocator* backing = &g_defaultAllocator);
+
+	TrackingAllocator(const TrackingAllocator&) = delete;
+	TrackingAllocator& operator=(const TrackingAllocator&) = delete;
+
+	void* alloc(usize size, usize alignment = 1);
+	void dealloc(void* ptr);
+
+	Stats snapshot() const;
+
+	Allocator* allocator() { return &allocator_; }
+
+	static constexpr usize sizeClass(usize size)
+	{
+		if (size <= 16)
+			return 0;
+		return min(usize(std::bit_width(size - 1)) - 4, SizeClassCount - 1);
+	}
+
+	Allocator allocator_;
+	Allocator* backing_ = nullptr;
+
+	std::atomic<u64> liveBytes_ = 0;
+	std::atomic<u64> peakBytes_ = 0;
+	std::atomic<u64> allocCount_ = 0;
+	std::atomic<u64> deallocCount_ = 0;
+	std::atomic<u64> sizeClasses_[SizeClassCount] = {};
+};
+
+////////////////////////////////////////////////////////////
+// Fixed Vector
+//
+// Note on constexpr: it's impossible to use FixedVector in a constexpr context
+// as reinterpret_cast is not allowed in a constexpr context. reinterpret_cast
+// is essential for the implementation.
+
+template <typename T, usize Capacity>
+struct FixedVector {
+	FixedVector() noexcept = default;
+	FixedVector(Span<T> span) { assignSpan(span); }
+	FixedVector(Span<const T> span) { assignSpan(span); }
+	FixedVector(std::initializer_list<T> init) { assignRange(init.begin(), init.end()); }
+
+	~FixedVector() noexcept { clear(); }
+
+	FixedVector(const FixedVector& other)
+	    requires(std::is_copy_constructible_v<T>)
+	{
+		std::uninitialized_copy(other.begin(), other.end(), begin());
+		size_ = other.size_;
+	}
+
+	FixedVector& operator=(const FixedVector& other)
+	    requires(std::is_copy_constructible_v<T>)
+	{
+		if (&other != this) {
+			clear();
+			std::uninitialized_copy(other.begin(), other.end(), begin());
+			size_ = other.size_;
+		}
+		return *this;
+	}
+
+	FixedVector(FixedVector&& other) noexcept
+	    requires(std::is_nothrow_move_constructible_v<T>)
+	{
+		std::uninitialized_move(other.begin(), other.end(), begin());
+		size_ = other.size_;
+		other.clear();
+	}
+
+	FixedVector& operator=(FixedVector&& other) noexcept
+	    requires(std::is_nothrow_move_constructible_v<T>)
+	{
+		if (&other != this) {
+			clear();
+			std::uninitialized_move(other.begin(), other.end(), begin());
+			size_ = other.size_;
+			other.clear();
+		}
+		return *this;
+	}
+
+	usize size() const { return size_; }
+	usize sizeBytes() const { return sizeof(T) * size_; }
 	usize capacity() const { return Capacity; }
 
 	bool empty() const { return size_ == 0; }
@@ -792,102 +1579,1999 @@ struct FixedVector {
 };
 
 ////////////////////////////////////////////////////////////
-// String Utilities
-
-inline constexpr i32 sCmp(const char* a, const char* b)
-{
-	MY_ASSERT(a && b, 0);
-	while (*a && (*a == *b)) {
-		a++;
-		b++;
-	}
-	return std::bit_cast<u8>(*a) - std::bit_cast<u8>(*b);
-}
-
-inline constexpr bool sEq(const char* a, const char* b)
-{
-	return sCmp(a, b) == 0;
-}
-
-inline constexpr bool sLess(const char* a, const char* b)
-{
-	return sCmp(a, b) < 0;
-}
+// Vector
+//
+// A dynamically sized array, allocating its storage from the given Allocator.
+// Capacity grows geometrically, hence appending is amortized O(1). Element
+// pointers are invalidated whenever the storage is reallocated.
 
-inline constexpr usize sLength(const char* s)
-{
-	MY_ASSERT(s, 0);
-	usize length = 0;
-	while (s[length] != '\0')
-		length++;
-	return length;
-}
+template <typename T>
+struct Vector {
+	constexpr Vector() = default;
+	constexpr explicit Vector(Allocator* allocator) : allocator_(allocator) {}
+	Vector(Span<T> span) { assignSpan(span); }
+	Vector(Span<const T> span) { assignSpan(span); }
+	Vector(std::initializer_list<T> init) { assignRange(init.begin(), init.end()); }
 
-////////////////////////////////////////////////////////////
-// Fixed String
+	~Vector() noexcept { reset(); }
 
-template <usize Capacity>
-struct FixedString {
-	constexpr FixedString() = default;
-	constexpr FixedString(const char* s) { *this = s; }
+	Vector(const Vector& other)
+	    requires(std::is_copy_constructible_v<T>)
+	    : allocator_(other.allocator_)
+	{
+		assignRange(other.begin(), other.end());
+	}
 
-	constexpr FixedString& operator=(const char* s)
+	Vector& operator=(const Vector& other)
+	    requires(std::is_copy_constructible_v<T>)
 	{
-		usize size = sLength(s);
-		MY_ASSERT(size <= Capacity - 1, *this);
-		for (usize i = 0; i < size + 1; i++) {
-			data_[i] = s[i];
+		if (&other != this) {
+			assignRange(other.begin(), other.end());
 		}
-		size_ = size;
 		return *this;
 	}
 
-	constexpr FixedString(const FixedString&) = default;
-	constexpr FixedString& operator=(const FixedString&) = default;
-	constexpr FixedString(FixedString&&) noexcept = default;
-	constexpr FixedString& operator=(FixedString&&) noexcept = default;
+	Vector(Vector&& other) noexcept { swap(other); }
 
-	constexpr void clear()
+	Vector& operator=(Vector&& other) noexcept
 	{
-		for (usize i = 0; i < size_; i++) {
-			data_[i] = '\0';
+		if (&other != this) {
+			reset();
+			swap(other);
 		}
-		size_ = 0;
+		return *this;
 	}
 
-	constexpr char* data() { return data_; }
-	constexpr const char* data() const { return data_; }
-	constexpr const char* c_str() const { return data_; }
+	usize size() const { return size_; }
+	usize sizeBytes() const { return sizeof(T) * size_; }
+	usize capacity() const { return capacity_; }
 
-	constexpr usize size() const { return size_; }
-	constexpr usize capacity() const { return Capacity; }
+	bool empty() const { return size_ == 0; }
 
-	constexpr bool empty() const { return size_ == 0; }
-	constexpr bool full() const { return size_ == Capacity - 1; }
+	T* data() { return data_; }
+	const T* data() const { return data_; }
 
-	constexpr char* begin() { return data_; }
-	constexpr char* end() { return data_ + size_; }
-	constexpr const char* begin() const { return data_; }
-	constexpr const char* end() const { return data_ + size_; }
+	T* begin() { return data_; }
+	const T* begin() const { return data_; }
+	T* end() { return data_ + size_; }
+	const T* end() const { return data_ + size_; }
 
-	constexpr char* operator[](usize index)
+	T* operator[](usize index)
 	{
 		MY_ASSERT(index < size_, nullptr);
-		return &data_[index];
+		return data_ + index;
 	}
-	constexpr const char* operator[](usize index) const
+	const T* operator[](usize index) const
 	{
 		MY_ASSERT(index < size_, nullptr);
-		return &data_[index];
+		return data_ + index;
 	}
 
-	constexpr operator Span<char>() { return Span(begin(), end()); }
-	constexpr operator Span<const char>() const { return Span(begin(), end()); }
+	T* front() { return operator[](0); }
+	const T* front() const { return operator[](0); }
+	T* back() { return operator[](size_ - 1); }
+	const T* back() const { return operator[](size_ - 1); }
 
-	usize size_ = 0;
-	char data_[Capacity + 1] = {};
+	template <typename... Args>
+	void emplace(T* pos, Args&&... args)
+	{
+		MY_ASSERT(begin() <= pos && pos <= end());
+		usize index = usize(pos - begin());
 
-	static_assert(Capacity > 0);
+		// Without storage, the vector is empty and args cannot refer to it.
+		if (!data_) {
+			reserve(MinCapacity);
+			MY_ASSERT(data_);
+			pos = data_;
+		}
+
+		// In both paths, the new element is constructed before relocating the
+		// existing ones as args may refer to elements of this vector.
+		if (size_ < capacity_) {
+			if (pos == end()) {
+				std::construct_at(pos, std::forward<Args>(args)...);
+			}
+			else {
+				T v(std::forward<Args>(args)...);
+				relocateUninitBackward(pos, end(), end() + 1);
+				std::construct_at(pos, std::move(v));
+			}
+			size_++;
+			return;
+		}
+
+		usize newCapacity = grownCapacity_(size_ + 1);
+		T* newData = allocate_(newCapacity);
+		MY_ASSERT(newData);
+		std::construct_at(newData + index, std::forward<Args>(args)...);
+		relocateUninit(begin(), pos, newData);
+		relocateUninit(pos, end(), newData + index + 1);
+		replaceStorage_(newData, newCapacity);
+		size_++;
+	}
+
+	void insert(T* pos, const T& v) { emplace(pos, v); }
+
+	template <typename It>
+	void insertRange(T* pos, It first, It last)
+	{
+		MY_ASSERT(begin() <= pos && pos <= end());
+		usize index = usize(pos - begin());
+		usize insertSize = usize(std::distance(first, last));
+		if (insertSize == 0)
+			return;
+
+		if (!data_) {
+			reserve(grownCapacity_(insertSize));
+			MY_ASSERT(data_);
+			pos = data_;
+		}
+
+		// A range within this vector would be shifted before being copied,
+		// hence it is copied into new storage like on growth.
+		bool aliased = false;
+		if constexpr (std::is_pointer_v<It>) {
+			aliased = first < end() && begin() < last;
+		}
+
+		bool fits = insertSize <= capacity_ - size_;
+		if (fits && !aliased) {
+			relocateUninitBackward(pos, end(), end() + insertSize);
+			std::uninitialized_copy(first, last, pos);
+			size_ += insertSize;
+			return;
+		}
+
+		usize newCapacity = fits ? capacity_ : grownCapacity_(size_ + insertSize);
+		T* newData = allocate_(newCapacity);
+		MY_ASSERT(newData);
+		std::uninitialized_copy(first, last, newData + index);
+		relocateUninit(begin(), pos, newData);
+		relocateUninit(pos, end(), newData + index + insertSize);
+		replaceStorage_(newData, newCapacity);
+		size_ += insertSize;
+	}
+
+	void insertSpan(T* pos, Span<T> span) { insertRange(pos, span.begin(), span.end()); }
+	void insertSpan(T* pos, Span<const T> span) { insertRange(pos, span.begin(), span.end()); }
+
+	void append(const T& v) { insert(end(), v); }
+
+	template <typename... Args>
+	void appendEmplace(Args&&... args)
+	{
+		emplace(end(), std::forward<Args>(args)...);
+	}
+
+	template <typename It>
+	void appendRange(It first, It last)
+	{
+		insertRange(end(), first, last);
+	}
+
+	void appendSpan(Span<T> span) { insertRange(end(), span.begin(), span.end()); }
+	void appendSpan(Span<const T> span) { insertRange(end(), span.begin(), span.end()); }
+
+	void prepend(const T& v) { insert(begin(), v); }
+
+	template <typename... Args>
+	void prependEmplace(Args&&... args)
+	{
+		emplace(begin(), std::forward<Args>(args)...);
+	}
+
+	void prependSpan(Span<T> span) { insertRange(begin(), span.begin(), span.end()); }
+	void prependSpan(Span<const T> span) { insertRange(begin(), span.begin(), span.end()); }
+
+	template <typename It>
+	void assignRange(It first, It last)
+	{
+		clear();
+		insertRange(begin(), first, last);
+	}
+
+	void assignSpan(Span<const T> span) { assignRange(span.begin(), span.end()); }
+
+	void resize(usize newSize)
+	{
+		if (newSize < size_) {
+			removeRange(begin() + newSize, end());
+			return;
+		}
+		if (newSize > capacity_)
+			reserve(grownCapacity_(newSize));
+		MY_ASSERT(newSize <= capacity_);
+		std::uninitialized_default_construct(end(), begin() + newSize);
+		size_ = newSize;
+	}
+
+	void resizeWith(usize newSize, const T& v)
+	{
+		if (newSize < size_) {
+			removeRange(begin() + newSize, end());
+			return;
+		}
+		// v may refer to an element of this vector.
+		T copy = v;
+		if (newSize > capacity_)
+			reserve(grownCapacity_(newSize));
+		MY_ASSERT(newSize <= capacity_);
+		std::uninitialized_fill(end(), begin() + newSize, copy);
+		size_ = newSize;
+	}
+
+	void remove(T* pos) { removeRange(pos, pos + 1); }
+
+	void removeRange(T* first, T* last)
+	{
+		MY_ASSERT(first <= last);
+		MY_ASSERT(begin() <= first && first <= end());
+		MY_ASSERT(begin() <= last && last <= end());
+		std::destroy(first, last);
+		relocateUninit(last, end(), first);
+		size_ -= usize(last - first);
+	}
+
+	void clear()
+	{
+		std::destroy(begin(), end());
+		size_ = 0;
+	}
+
+	// Clears the vector and releases its storage.
+	void reset()
+	{
+		clear();
+		replaceStorage_(nullptr, 0);
+	}
+
+	void reserve(usize newCapacity)
+	{
+		if (newCapacity <= capacity_)
+			return;
+		T* newData = allocate_(newCapacity);
+		MY_ASSERT(newData);
+		if (data_) {
+			relocateUninit(begin(), end(), newData);
+		}
+		replaceStorage_(newData, newCapacity);
+	}
+
+	void shrinkToFit()
+	{
+		if (size_ == capacity_)
+			return;
+		if (size_ == 0) {
+			reset();
+			return;
+		}
+		T* newData = allocate_(size_);
+		MY_ASSERT(newData);
+		relocateUninit(begin(), end(), newData);
+		replaceStorage_(newData, size_);
+	}
+
+	void swap(Vector& other) noexcept
+	{
+		std::swap(allocator_, other.allocator_);
+		std::swap(data_, other.data_);
+		std::swap(size_, other.size_);
+		std::swap(capacity_, other.capacity_);
+	}
+
+	operator Span<T>() { return Span(begin(), end()); }
+	operator Span<const T>() const { return Span(begin(), end()); }
+
+	usize grownCapacity_(usize required) const { return max(max(required, capacity_ * 2), MinCapacity); }
+
+	T* allocate_(usize capacity)
+	{
+		MY_ASSERT(capacity <= usize(-1) / sizeof(T), nullptr);
+		return static_cast<T*>(allocator_->alloc(capacity * sizeof(T), alignof(T)));
+	}
+
+	void replaceStorage_(T* newData, usize newCapacity)
+	{
+		if (data_) {
+			allocator_->dealloc(data_);
+		}
+		data_ = newData;
+		capacity_ = newCapacity;
+	}
+
+	static constexpr usize MinCapacity = 4;
+
+	Allocator* allocator_ = &g_defaultAllocator;
+	T* data_ = nullptr;
+	usize size_ = 0;
+	usize capacity_ = 0;
+};
+
+// Vector only holds pointers to its storage, which remain valid when moved.
+template <typename T>
+constexpr bool TriviallyRelocatable<Vector<T>> = true;
+
+////////////////////////////////////////////////////////////
+// Hash Map
+//
+// An open-addressing hash map using Robin Hood hashing with backward shift
+// deletion. Entries and per-slot probe distances are stored in a single
+// allocation obtained from the given Allocator.
+//
+// A probe distance of 0 marks an empty slot, otherwise it's the distance from
+// the entry's home slot plus one. Distances are stored as u8; the map grows
+// early when an insertion would exceed this limit. Hence, at most 255 keys with
+// identical hashes can be stored.
+//
+// Keys are hashed via the Hash policy (see IdentityHash / MixedHash). The home
+// slot is taken from the high bits of the hash multiplied by a Fibonacci
+// constant, which also tolerates IdentityHash for well-distributed keys.
+//
+// Pointers returned by find / insert are invalidated by any operation that
+// inserts or removes entries.
+
+template <typename K, typename V, typename Hash = MixedHash>
+struct HashMap {
+	struct Entry {
+		K key;
+		V value;
+	};
+
+	constexpr HashMap() = default;
+	constexpr explicit HashMap(Allocator* allocator) : allocator_(allocator) {}
+
+	~HashMap() noexcept { reset(); }
+
+	HashMap(const HashMap& other)
+	    requires(std::is_copy_constructible_v<K> && std::is_copy_constructible_v<V>)
+	    : allocator_(other.allocator_)
+	{
+		*this = other;
+	}
+
+	HashMap& operator=(const HashMap& other)
+	    requires(std::is_copy_constructible_v<K> && std::is_copy_constructible_v<V>)
+	{
+		if (&other != this) {
+			clear();
+			reserve(other.size_);
+			for (auto [key, value] : other) {
+				insert(key, value);
+			}
+		}
+		return *this;
+	}
+
+	HashMap(HashMap&& other) noexcept { swap(other); }
+
+	HashMap& operator=(HashMap&& other) noexcept
+	{
+		if (&other != this) {
+			reset();
+			swap(other);
+		}
+		return *this;
+	}
+
+	usize size() const { return size_; }
+	usize capacity() const { return capacity_; }
+	bool empty() const { return size_ == 0; }
+
+	V* find(const K& key)
+	{
+		usize index = 0;
+		return findIndex_(key, &index) ? &entries_[index].value : nullptr;
+	}
+	const V* find(const K& key) const { return const_cast<HashMap*>(this)->find(key); }
+
+	bool contains(const K& key) const { return find(key) != nullptr; }
+
+	// Inserts the key / value pair, overwriting the value of an existing entry.
+	V* insert(const K& key, const V& value)
+	{
+		if (V* existing = find(key)) {
+			*existing = value;
+			return existing;
+		}
+		return emplaceNew_(key, value);
+	}
+
+	// Constructs a new entry from the given arguments, unless the key is
+	// already present. In both cases the value associated with key is
+	// returned.
+	template <typename... Args>
+	V* emplace(const K& key, Args&&... args)
+	{
+		if (V* existing = find(key))
+			return existing;
+		return emplaceNew_(key, std::forward<Args>(args)...);
+	}
+
+	bool remove(const K& key)
+	{
+		usize index = 0;
+		if (!findIndex_(key, &index))
+			return false;
+
+		std::destroy_at(&entries_[index]);
+
+		// Backward shift deletion: pull subsequent entries of the cluster one
+		// slot closer to their home, until an empty slot or an entry already
+		// at its home is reached.
+		usize mask = capacity_ - 1;
+		usize next = (index + 1) & mask;
+		while (distances_[next] > 1) {
+			std::construct_at(&entries_[index], std::move(entries_[next]));
+			std::destroy_at(&entries_[next]);
+			distances_[index] = u8(distances_[next] - 1);
+			index = next;
+			next = (next + 1) & mask;
+		}
+		distances_[index] = 0;
+
+		size_--;
+		return true;
+	}
+
+	void clear()
+	{
+		for (usize i = 0; i < capacity_; i++) {
+			if (distances_[i]) {
+				std::destroy_at(&entries_[i]);
+				distances_[i] = 0;
+			}
+		}
+		size_ = 0;
+	}
+
+	// Clears the map and releases its storage.
+	void reset()
+	{
+		clear();
+		if (entries_) {
+			allocator_->dealloc(entries_);
+		}
+		entries_ = nullptr;
+		distances_ = nullptr;
+		capacity_ = 0;
+		shift_ = 64;
+	}
+
+	// Ensures count entries can be stored without growing.
+	void reserve(usize count)
+	{
+		if (count == 0)
+			return;
+		usize newCapacity = MinCapacity;
+		while (newCapacity - newCapacity / 8 < count)
+			newCapacity *= 2;
+		if (newCapacity > capacity_)
+			rehash_(newCapacity);
+	}
+
+	void swap(HashMap& other) noexcept
+	{
+		std::swap(allocator_, other.allocator_);
+		std::swap(entries_, other.entries_);
+		std::swap(distances_, other.distances_);
+		std::swap(size_, other.size_);
+		std::swap(capacity_, other.capacity_);
+		std::swap(shift_, other.shift_);
+	}
+
+	// Iteration exposes the key as const, as modifying it would corrupt the map.
+	template <typename VV>
+	struct EntryRef {
+		const K& key;
+		VV& value;
+	};
+
+	template <typename VV>
+	struct Iterator {
+		Iterator& operator++()
+		{
+			index_++;
+			skipEmpty_();
+			return *this;
+		}
+
+		EntryRef<VV> operator*() const
+		{
+			Entry& entry = map_->entries_[index_];
+			return {entry.key, entry.value};
+		}
+
+		bool operator==(const Iterator& other) const { return index_ == other.index_; }
+
+		void skipEmpty_()
+		{
+			while (index_ < map_->capacity_ && map_->distances_[index_] == 0)
+				index_++;
+		}
+
+		const HashMap* map_ = nullptr;
+		usize index_ = 0;
+	};
+
+	Iterator<V> begin() { return makeIterator_<V>(0); }
+	Iterator<V> end() { return makeIterator_<V>(capacity_); }
+	Iterator<const V> begin() const { return makeIterator_<const V>(0); }
+	Iterator<const V> end() const { return makeIterator_<const V>(capacity_); }
+
+	template <typename VV>
+	Iterator<VV> makeIterator_(usize index) const
+	{
+		Iterator<VV> it{this, index};
+		it.skipEmpty_();
+		return it;
+	}
+
+	usize homeIndex_(const K& key) const { return usize((Hash{}(key) * 0x9E3779B97F4A7C15u) >> shift_); }
+
+	bool findIndex_(const K& key, usize* outIndex) const
+	{
+		if (size_ == 0)
+			return false;
+
+		usize mask = capacity_ - 1;
+		usize index = homeIndex_(key);
+		for (u32 distance = 1;; distance++) {
+			if (distances_[index] < distance)
+				return false;
+			if (distances_[index] == distance && entries_[index].key == key) {
+				*outIndex = index;
+				return true;
+			}
+			index = (index + 1) & mask;
+		}
+	}
+
+	// Inserts a key which is known to be absent.
+	template <typename KK, typename... Args>
+	V* emplaceNew_(KK&& key, Args&&... args)
+	{
+		// Constructed before growing, as key and args may refer to entries of
+		// this map.
+		Entry entry{K(std::forward<KK>(key)), V(std::forward<Args>(args)...)};
+
+		if (size_ + 1 > capacity_ - capacity_ / 8)
+			reserve(size_ + 1);
+
+		// Growing once resolves clusters caused by unlucky, but distinct,
+		// hashes. Failing after that indicates too many identical hashes.
+		usize index = 0;
+		u8 distance = 0;
+		bool found = capacity_ > 0 && makeSlot_<true>(homeIndex_(entry.key), &index, &distance);
+		if (!found && rehash_(max(capacity_ * 2, MinCapacity)))
+			found = makeSlot_<true>(homeIndex_(entry.key), &index, &distance);
+		MY_ASSERT(found, nullptr);
+
+		std::construct_at(&entries_[index], std::move(entry));
+		distances_[index] = distance;
+		size_++;
+		return &entries_[index].value;
+	}
+
+	// Frees the slot where a key with the given home slot is to be inserted, by
+	// shifting the remainder of its cluster up by one slot. Returns false,
+	// without modifying the map, if the insertion would overflow a probe
+	// distance. Without MoveEntries only distances are shifted, which allows
+	// simulating insertions.
+	template <bool MoveEntries>
+	bool makeSlot_(usize home, usize* outIndex, u8* outDistance)
+	{
+		usize mask = capacity_ - 1;
+		usize index = home;
+		u32 distance = 1;
+		while (distances_[index] >= distance) {
+			index = (index + 1) & mask;
+			distance++;
+		}
+		if (distance > MaxDistance)
+			return false;
+
+		usize empty = index;
+		while (distances_[empty] != 0) {
+			if (distances_[empty] == MaxDistance)
+				return false;
+			empty = (empty + 1) & mask;
+		}
+		while (empty != index) {
+			usize prev = (empty - 1) & mask;
+			if constexpr (MoveEntries) {
+				std::construct_at(&entries_[empty], std::move(entries_[prev]));
+				std::destroy_at(&entries_[prev]);
+			}
+			distances_[empty] = u8(distances_[prev] + 1);
+			empty = prev;
+		}
+
+		*outIndex = index;
+		*outDistance = u8(distance);
+		return true;
+	}
+
+	// Moves all entries into storage of the given capacity. Either all entries
+	// are moved or, on failure, the map is left unchanged.
+	bool rehash_(usize newCapacity)
+	{
+		MY_ASSERT(std::has_single_bit(newCapacity), false);
+
+		usize entriesSize = newCapacity * sizeof(Entry);
+		auto* storage = static_cast<u8*>(allocator_->alloc(entriesSize + newCapacity, alignof(Entry)));
+		MY_ASSERT(storage, false);
+
+		Entry* oldEntries = entries_;
+		u8* oldDistances = distances_;
+		usize oldCapacity = capacity_;
+		u32 oldShift = shift_;
+
+		entries_ = reinterpret_cast<Entry*>(storage);
+		distances_ = storage + entriesSize;
+		capacity_ = newCapacity;
+		shift_ = u32(64 - std::countr_zero(newCapacity));
+
+		// Placement only depends on the probe distances, so a dry run detects
+		// overflows before any entry is moved.
+		for (int pass = 0; pass < 2; pass++) {
+			for (usize i = 0; i < newCapacity; i++) {
+				distances_[i] = 0;
+			}
+			for (usize i = 0; i < oldCapacity; i++) {
+				if (!oldDistances[i])
+					continue;
+				usize index = 0;
+				u8 distance = 0;
+				if (pass == 0) {
+					if (!makeSlot_<false>(homeIndex_(oldEntries[i].key), &index, &distance)) {
+						entries_ = oldEntries;
+						distances_ = oldDistances;
+						capacity_ = oldCapacity;
+						shift_ = oldShift;
+						allocator_->dealloc(storage);
+						return false;
+					}
+				}
+				else {
+					makeSlot_<true>(homeIndex_(oldEntries[i].key), &index, &distance);
+					std::construct_at(&entries_[index], std::move(oldEntries[i]));
+					std::destroy_at(&oldEntries[i]);
+				}
+				distances_[index] = distance;
+			}
+		}
+
+		if (oldEntries) {
+			allocator_->dealloc(oldEntries);
+		}
+		return true;
+	}
+
+	static constexpr usize MinCapacity = 8;
+	static constexpr u32 MaxDistance = 255;
+
+	Allocator* allocator_ = &g_defaultAllocator;
+	Entry* entries_ = nullptr;
+	u8* distances_ = nullptr;
+	usize size_ = 0;
+	usize capacity_ = 0;
+	u32 shift_ = 64;
+};
+
+////////////////////////////////////////////////////////////
+// String Utilities
+//
+// At run-time, comparison and length computation are delegated to the C
+// library, whose implementations process 16 - 64 bytes per step (SSE2, AVX2,
+// NEON, ...) without reading across page boundaries. The scalar loops remain
+// for constant evaluation.
+//
+// sCmp only guarantees the sign of its result; the magnitude may differ
+// between run-time and constant evaluation.
+
+inline constexpr i32 sCmp(const char* a, const char* b)
+{
+	MY_ASSERT(a && b, 0);
+	if (!std::is_constant_evaluated())
+		return strcmp(a, b);
+	while (*a && (*a == *b)) {
+		a++;
+		b++;
+	}
+	return std::bit_cast<u8>(*a) - std::bit_cast<u8>(*b);
+}
+
+inline constexpr bool sEq(const char* a, const char* b)
+{
+	return sCmp(a, b) == 0;
+}
+
+inline constexpr bool sLess(const char* a, const char* b)
+{
+	return sCmp(a, b) < 0;
+}
+
+inline constexpr usize sLength(const char* s)
+{
+	MY_ASSERT(s, 0);
+	if (!std::is_constant_evaluated())
+		return strlen(s);
+	usize length = 0;
+	while (s[length] != '\0')
+		length++;
+	return length;
+}
+
+// Number parsing consumes a number at the beginning of s. Leading whitespace is
+// not skipped. On success, the result is written to out and a pointer past the
+// consumed characters is returned. On failure (no digits, out of range),
+// nullptr is returned and out is left untouched.
+//
+// Digits are converted 8 at a time where possible (SWAR). Floats are parsed
+// exactly when mantissa and exponent are small enough (Clinger's fast path);
+// other cases fall back to std::from_chars. Both are locale-independent.
+
+inline constexpr bool isEightDigits_(u64 v)
+{
+	return ((v & 0xf0f0f0f0f0f0f0f0) | (((v + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) == 0x3333333333333333;
+}
+
+// Converts 8 ASCII digits, loaded in little-endian order.
+inline constexpr u32 parseEightDigits_(u64 v)
+{
+	constexpr u64 mask = 0x000000ff000000ff;
+	constexpr u64 mul1 = 100 + (1000000ull << 32);
+	constexpr u64 mul2 = 1 + (10000ull << 32);
+	v -= 0x3030303030303030;
+	v = (v * 10) + (v >> 8);
+	return u32((((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32);
+}
+
+// Accumulates decimal digits into value, which wraps around on overflow.
+// Returns a pointer past the last digit.
+inline constexpr const char* parseDigits_(const char* p, const char* end, u64* value)
+{
+	u64 v = *value;
+	while (end - p >= 8) {
+		u64 chunk = hashLoad64_(p);
+		if (!isEightDigits_(chunk))
+			break;
+		v = v * 100000000 + parseEightDigits_(chunk);
+		p += 8;
+	}
+	while (p < end && u8(*p - '0') < 10) {
+		v = v * 10 + u64(*p - '0');
+		p++;
+	}
+	*value = v;
+	return p;
+}
+
+template <typename T>
+    requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+constexpr const char* sToI(Span<const char> s, T* out)
+{
+	const char* p = s.begin();
+	const char* end = s.end();
+
+	bool negative = false;
+	if (p < end && (*p == '+' || (std::is_signed_v<T> && *p == '-'))) {
+		negative = *p == '-';
+		p++;
+	}
+
+	const char* digits = p;
+	while (p < end && *p == '0')
+		p++;
+	const char* significant = p;
+
+	u64 v = 0;
+	p = parseDigits_(p, end, &v);
+	if (p == digits)
+		return nullptr;
+
+	// With 20 significant digits, the value may have wrapped around. Checking
+	// the leading 19 digits against UINT64_MAX / 10 before the last step is
+	// exact.
+	usize count = usize(p - significant);
+	if (count > 20)
+		return nullptr;
+	if (count == 20) {
+		constexpr u64 Max = ~u64(0) / 10;
+		u64 head = 0;
+		parseDigits_(significant, p - 1, &head);
+		if (head > Max || (head == Max && u64(p[-1] - '0') > ~u64(0) % 10))
+			return nullptr;
+	}
+
+	using U = std::make_unsigned_t<T>;
+	u64 limit = std::is_signed_v<T> ? u64(U(~U(0)) >> 1) + (negative ? 1 : 0) : u64(U(~U(0)));
+	if (v > limit)
+		return nullptr;
+
+	*out = T(negative ? U(0 - v) : U(v));
+	return p;
+}
+
+const char* sToF(Span<const char> s, f32* out);
+const char* sToF(Span<const char> s, f64* out);
+
+////////////////////////////////////////////////////////////
+// Type-safe Formatting
+//
+// sPrint is a faster alternative to sFormat. Arguments are formatted according
+// to their type, hence placeholders carry no type information:
+//
+//     sPrint(buffer, "{} of {} ({:x})", 3, count, flags);
+//
+// Supported placeholders are {} and {:x} (hexadecimal, integers and pointers
+// only); {{ and }} produce literal braces. The format string is validated
+// against the arguments at compile-time.
+//
+// Integers are converted using a table of digit pairs. Floating-point values
+// are printed with the shortest representation that round-trips. Like sFormat,
+// the result is null-terminated and the number of characters written
+// (including the null-terminator) is returned.
+
+template <typename... Args>
+struct FormatString {
+	template <usize N>
+	consteval FormatString(const char (&fmt)[N]) : data(fmt), size(N - 1)
+	{
+		constexpr bool hexable[] = {
+		    (std::is_enum_v<std::decay_t<Args>> || std::is_pointer_v<std::decay_t<Args>>
+		        || (std::is_integral_v<std::decay_t<Args>> && !std::is_same_v<std::decay_t<Args>, bool>))...,
+		    false};
+
+		usize count = 0;
+		for (usize i = 0; i < size; i++) {
+			bool next = i + 1 < size;
+			if (fmt[i] == '{' && next && fmt[i + 1] == '{') {
+				i++;
+			}
+			else if (fmt[i] == '{' && next && fmt[i + 1] == '}') {
+				count++;
+				i++;
+			}
+			else if (fmt[i] == '{' && i + 3 < size && fmt[i + 1] == ':' && fmt[i + 2] == 'x' && fmt[i + 3] == '}') {
+				if (count >= sizeof...(Args) || !hexable[count])
+					formatStringError_("{:x} requires an integer or pointer argument");
+				count++;
+				i += 3;
+			}
+			else if (fmt[i] == '{') {
+				formatStringError_("invalid placeholder");
+			}
+			else if (fmt[i] == '}' && next && fmt[i + 1] == '}') {
+				i++;
+			}
+			else if (fmt[i] == '}') {
+				formatStringError_("unmatched }");
+			}
+		}
+		if (count != sizeof...(Args))
+			formatStringError_("number of placeholders does not match number of arguments");
+	}
+
+	// Not constexpr, calling it during constant evaluation fails compilation.
+	static void formatStringError_(const char* reason);
+
+	const char* data = nullptr;
+	usize size = 0;
+};
+
+inline constexpr char DigitPairs_[] = "0001020304050607080910111213141516171819"
+                                       "2021222324252627282930313233343536373839"
+                                       "4041424344454647484950515253545556575859"
+                                       "6061626364656667686970717273747576777879"
+                                       "8081828384858687888990919293949596979899";
+
+// Writes the decimal digits of v right-aligned in front of end. Returns the
+// first digit.
+inline char* formatDecimal_(char* end, u64 v)
+{
+	while (v >= 100) {
+		usize pair = usize(v % 100) * 2;
+		v /= 100;
+		end -= 2;
+		memcpy(end, DigitPairs_ + pair, 2);
+	}
+	if (v >= 10) {
+		end -= 2;
+		memcpy(end, DigitPairs_ + usize(v) * 2, 2);
+	}
+	else {
+		*--end = char('0' + v);
+	}
+	return end;
+}
+
+inline char* formatHex_(char* end, u64 v)
+{
+	do {
+		*--end = "0123456789abcdef"[v & 0xf];
+		v >>= 4;
+	} while (v);
+	return end;
+}
+
+// Writes the shortest representation of v that round-trips. dst must provide
+// room for FloatFormatSize_ characters. Returns the number of characters.
+constexpr usize FloatFormatSize_ = 32;
+usize formatFloat_(char* dst, f32 v);
+usize formatFloat_(char* dst, f64 v);
+
+struct FormatWriter_ {
+	// Like sFormat, nothing is written to an empty dst, not even a terminator.
+	explicit FormatWriter_(Span<char> dst)
+	    : data_(dst.size ? dst.data : nullptr), capacity_(dst.size ? dst.size - 1 : 0)
+	{
+	}
+
+	void put(const char* s, usize length)
+	{
+		length = min(length, capacity_ - size_);
+		if (length > 0) {
+			memcpy(data_ + size_, s, length);
+		}
+		size_ += length;
+	}
+
+	void putString(const char* s)
+	{
+		if (!s) {
+			s = "(null)";
+		}
+		put(s, sLength(s));
+	}
+
+	// Copies literal text up to the next placeholder, which is consumed.
+	// Returns whether the placeholder requests hexadecimal output.
+	bool literal(const char** fmt, const char* end)
+	{
+		const char* p = *fmt;
+		while (p < end) {
+			const char* begin = p;
+			while (p < end && *p != '{' && *p != '}')
+				p++;
+			put(begin, usize(p - begin));
+			if (p == end)
+				break;
+
+			if (p[0] == p[1]) { // escaped brace
+				put(p, 1);
+				p += 2;
+				continue;
+			}
+
+			bool hex = p[1] == ':';
+			*fmt = p + (hex ? 4 : 2);
+			return hex;
+		}
+		*fmt = p;
+		return false;
+	}
+
+	template <typename T>
+	void arg(const T& v, bool hex)
+	{
+		using D = std::decay_t<T>;
+		if constexpr (std::is_same_v<D, char*> || std::is_same_v<D, const char*>) {
+			putString(v);
+		}
+		else if constexpr (std::is_convertible_v<const T&, Span<const char>>) {
+			Span<const char> s = v;
+			put(s.data, s.size);
+		}
+		else if constexpr (std::is_same_v<D, bool>) {
+			v ? put("true", 4) : put("false", 5);
+		}
+		else if constexpr (std::is_same_v<D, char>) {
+			hex ? arg(u8(v), true) : put(&v, 1);
+		}
+		else if constexpr (std::is_enum_v<D>) {
+			arg(std::underlying_type_t<D>(v), hex);
+		}
+		else if constexpr (std::is_integral_v<D>) {
+			char buffer[24];
+			char* end = buffer + sizeof(buffer);
+			char* begin;
+			if (hex) {
+				begin = formatHex_(end, u64(std::make_unsigned_t<D>(v)));
+			}
+			else if constexpr (std::is_signed_v<D>) {
+				begin = formatDecimal_(end, v < 0 ? 0 - u64(v) : u64(v));
+				if (v < 0) {
+					*--begin = '-';
+				}
+			}
+			else {
+				begin = formatDecimal_(end, u64(v));
+			}
+			put(begin, usize(end - begin));
+		}
+		else if constexpr (std::is_same_v<D, f32> || std::is_same_v<D, f64>) {
+			char buffer[FloatFormatSize_];
+			put(buffer, formatFloat_(buffer, v));
+		}
+		else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+			char buffer[24];
+			char* end = buffer + sizeof(buffer);
+			u64 address = 0;
+			if constexpr (std::is_pointer_v<D>) {
+				address = u64(reinterpret_cast<uintptr_t>(v));
+			}
+			char* begin = formatHex_(end, address);
+			*--begin = 'x';
+			*--begin = '0';
+			put(begin, usize(end - begin));
+		}
+		else {
+			static_assert(AlwaysFalse<T>, "unsupported format argument");
+		}
+	}
+
+	usize finish()
+	{
+		if (!data_)
+			return 0;
+		data_[size_] = '\0';
+		return size_ + 1 /* terminator */;
+	}
+
+	char* data_ = nullptr;
+	usize capacity_ = 0;
+	usize size_ = 0;
+};
+
+template <typename... Args>
+usize sPrint(Span<char> dst, FormatString<std::type_identity_t<Args>...> fmt, const Args&... args)
+{
+	FormatWriter_ writer(dst);
+	const char* p = fmt.data;
+	const char* end = fmt.data + fmt.size;
+	(writer.arg(args, writer.literal(&p, end)), ...);
+	writer.literal(&p, end);
+	return writer.finish();
+}
+
+////////////////////////////////////////////////////////////
+// Deferred Logging
+//
+// MY_LOG_DEFERRED skips formatting on the calling thread. Instead, the format
+// string pointer and the raw argument values are encoded into a compact record,
+// which is handed to onLogDeferred. Formatting happens later, typically on the
+// async log consumer thread, via formatDeferredLog. Format strings and
+// arguments are checked at compile-time, like for MY_LOG.
+//
+// Supported arguments are integers, enums, floating-point values, strings
+// (copied into the record) and pointers. Records refer to the format string by
+// address, hence they can only be decoded by the producing process.
+//
+// Without onLogDeferred, records are formatted immediately and passed to onLog.
+
+#define MY_LOG_DEFERRED(severity, ...) \
+	do { \
+		if (false) { \
+			::MY::checkLogFormat_(__VA_ARGS__); \
+		} \
+		if (::MY::logEnabled(severity) && (::MY::onLog || ::MY::onLogDeferred)) { \
+			::MY::logDeferred(severity, MY_FILENAME, __LINE__, __VA_ARGS__); \
+		} \
+	} while (0)
+
+MY_ATTR_PRINTF(1, 2)
+inline void checkLogFormat_(MY_ATTR_PRINTF_PARAM(const char*), ...) {}
+
+using OnLogDeferred = void(LogSeverity, Span<const u8> record, const char* file, long line) noexcept;
+extern OnLogDeferred* onLogDeferred;
+
+extern thread_local u8 g_logDeferredBuffer[MY_LOG_BUFFER_SIZE];
+
+// Formats a record into dst, see sFormat.
+usize formatDeferredLog(Span<char> dst, Span<const u8> record);
+
+void dispatchDeferredLog_(LogSeverity severity, Span<const u8> record, const char* file, long line);
+
+enum class DeferredLogArg : u8 { Int, UInt, Double, String, Pointer };
+
+struct DeferredLogWriter_ {
+	template <typename T>
+	void put(DeferredLogArg type, T v)
+	{
+		if (!fits(1 + sizeof(T)))
+			return;
+		record_.data[size_++] = u8(type);
+		putRaw(v);
+	}
+
+	template <typename T>
+	void putRaw(T v)
+	{
+		memcpy(record_.data + size_, &v, sizeof(T));
+		size_ += sizeof(T);
+	}
+
+	void putString(const char* s)
+	{
+		if (!s) {
+			s = "(null)";
+		}
+		usize overhead = 1 + sizeof(u32) + 1;
+		if (!fits(overhead))
+			return;
+		usize length = min(sLength(s), record_.size - size_ - overhead);
+		record_.data[size_++] = u8(DeferredLogArg::String);
+		putRaw(u32(length));
+		memcpy(record_.data + size_, s, length);
+		record_.data[size_ + length] = '\0';
+		size_ += length + 1;
+	}
+
+	template <typename T>
+	void arg(const T& v)
+	{
+		using D = std::decay_t<T>;
+		if constexpr (std::is_same_v<D, char*> || std::is_same_v<D, const char*>) {
+			putString(v);
+		}
+		else if constexpr (std::is_enum_v<D>) {
+			arg(std::underlying_type_t<D>(v));
+		}
+		else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+			put(DeferredLogArg::Int, i64(v));
+		}
+		else if constexpr (std::is_integral_v<D>) {
+			put(DeferredLogArg::UInt, u64(v));
+		}
+		else if constexpr (std::is_floating_point_v<D>) {
+			put(DeferredLogArg::Double, f64(v));
+		}
+		else if constexpr (std::is_pointer_v<D>) {
+			put(DeferredLogArg::Pointer, u64(reinterpret_cast<uintptr_t>(v)));
+		}
+		else if constexpr (std::is_null_pointer_v<D>) {
+			put(DeferredLogArg::Pointer, u64(0));
+		}
+		else {
+			static_assert(AlwaysFalse<T>, "unsupported deferred log argument");
+		}
+	}
+
+	bool fits(usize n) const { return n <= record_.size - size_; }
+
+	Span<u8> record_;
+	usize size_ = 0;
+};
+
+template <typename... Args>
+void logDeferred(LogSeverity severity, const char* file, long line, const char* fmt, const Args&... args)
+{
+	DeferredLogWriter_ writer{g_logDeferredBuffer};
+	writer.putRaw(fmt);
+	(writer.arg(args), ...);
+	dispatchDeferredLog_(severity, writer.record_.first(writer.size_), file, line);
+}
+
+////////////////////////////////////////////////////////////
+// Structured Logging
+//
+// MY_LOG_RECORD attaches typed key / value fields to a log message. Fields are
+// encoded into a compact, thread-local buffer instead of being formatted; sinks
+// receive a LogRecord and can iterate fields via nextLogField without parsing
+// any text.
+//
+//   MY_LOG_RECORD(LogSeverity::Info, "request done", "status", 200, "path", path);
+//
+// Supported values are booleans, integers, enums, floating-point values and
+// strings. Fields that do not fit into the buffer are dropped, overly long
+// strings are truncated.
+//
+// Records can be rendered as JSON-lines or encoded into a self-contained binary
+// frame. Without onLogRecord, records are rendered as text and passed to onLog.
+
+#define MY_LOG_RECORD(severity, message, ...) \
+	do { \
+		if (::MY::logEnabled(severity) && (::MY::onLog || ::MY::onLogRecord)) { \
+			::MY::logRecord(severity, MY_FILENAME, __LINE__, message __VA_OPT__(, ) __VA_ARGS__); \
+		} \
+	} while (0)
+
+enum class LogFieldType : u8 { Bool, Int, UInt, Double, String };
+
+struct LogField {
+	const char* key = nullptr;
+	LogFieldType type = LogFieldType::Int;
+	bool b = false;
+	i64 i = 0;
+	u64 u = 0;
+	f64 d = 0.0;
+	Span<const char> string; // null-terminated
+};
+
+struct LogRecord {
+	LogSeverity severity = LogSeverity::Info;
+	const char* message = nullptr;
+	const char* file = nullptr;
+	long line = 0;
+	Span<const u8> fields; // encoded
+};
+
+using OnLogRecord = void(const LogRecord* record) noexcept;
+extern OnLogRecord* onLogRecord;
+
+extern thread_local u8 g_logRecordBuffer[MY_LOG_BUFFER_SIZE];
+
+// Decodes the first field and removes it from fields. Returns false once all
+// fields have been consumed or if the encoding is malformed.
+bool nextLogField(Span<const u8>* fields, LogField* field);
+
+// Renders a record as "message key=value ...", see sFormat.
+usize formatLogRecordText(Span<char> dst, const LogRecord* record);
+
+// Renders a record as a single line of JSON, including the trailing newline,
+// see sFormat. If dst is too small, the message is cut short or fields are
+// dropped, keeping the output valid JSON; truncated is set then.
+usize formatLogRecordJson(Span<char> dst, const LogRecord* record, bool* truncated = nullptr);
+
+// Encodes a record into a self-contained binary frame. Returns the size of the
+// frame, or 0 if dst is too small.
+usize encodeLogRecord(Span<u8> dst, const LogRecord* record);
+
+// Decodes a frame created by encodeLogRecord. The resulting record refers to
+// memory of src. Returns the size of the frame, or 0 if malformed.
+usize decodeLogRecord(Span<const u8> src, LogRecord* record);
+
+// Sinks writing JSON-lines or binary frames to stdout.
+void logRecordJsonSink(const LogRecord* record) noexcept;
+void logRecordBinarySink(const LogRecord* record) noexcept;
+
+void dispatchLogRecord_(const LogRecord* record);
+
+struct LogRecordWriter_ {
+	void fields() {}
+
+	template <typename T, typename... Rest>
+	void fields(const char* key, const T& v, const Rest&... rest)
+	{
+		field(key, v);
+		fields(rest...);
+	}
+
+	template <typename T>
+	void field(const char* key, const T& v)
+	{
+		using D = std::decay_t<T>;
+		if constexpr (std::is_same_v<D, char*> || std::is_same_v<D, const char*>) {
+			putString(key, v);
+		}
+		else if constexpr (std::is_same_v<D, Span<char>> || std::is_same_v<D, Span<const char>>) {
+			putString(key, v);
+		}
+		else if constexpr (std::is_same_v<D, bool>) {
+			put(key, LogFieldType::Bool, u8(v));
+		}
+		else if constexpr (std::is_enum_v<D>) {
+			field(key, std::underlying_type_t<D>(v));
+		}
+		else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+			put(key, LogFieldType::Int, i64(v));
+		}
+		else if constexpr (std::is_integral_v<D>) {
+			put(key, LogFieldType::UInt, u64(v));
+		}
+		else if constexpr (std::is_floating_point_v<D>) {
+			put(key, LogFieldType::Double, f64(v));
+		}
+		else {
+			static_assert(AlwaysFalse<T>, "unsupported log field value");
+		}
+	}
+
+	// Writes type and key, provided that a value of the given size fits as well.
+	bool putKey(const char* key, LogFieldType type, usize valueSize)
+	{
+		usize keyLength = min(sLength(key), usize(UINT8_MAX));
+		if (2 + keyLength + 1 + valueSize > record_.size - size_)
+			return false;
+		record_.data[size_++] = u8(type);
+		record_.data[size_++] = u8(keyLength);
+		memcpy(record_.data + size_, key, keyLength);
+		record_.data[size_ + keyLength] = '\0';
+		size_ += keyLength + 1;
+		return true;
+	}
+
+	template <typename T>
+	void put(const char* key, LogFieldType type, T v)
+	{
+		if (!putKey(key, type, sizeof(T)))
+			return;
+		memcpy(record_.data + size_, &v, sizeof(T));
+		size_ += sizeof(T);
+	}
+
+	void putString(const char* key, const char* s)
+	{
+		if (!s) {
+			s = "(null)";
+		}
+		putString(key, Span(s, sLength(s)));
+	}
+
+	void putString(const char* key, Span<const char> s)
+	{
+		usize overhead = sizeof(u32) + 1;
+		if (!putKey(key, LogFieldType::String, overhead))
+			return;
+		u32 length = u32(min(s.size, record_.size - size_ - overhead));
+		memcpy(record_.data + size_, &length, sizeof(length));
+		size_ += sizeof(length);
+		memcpy(record_.data + size_, s.data, length);
+		record_.data[size_ + length] = '\0';
+		size_ += usize(length) + 1;
+	}
+
+	Span<u8> record_;
+	usize size_ = 0;
+};
+
+template <typename... Args>
+void logRecord(LogSeverity severity, const char* file, long line, const char* message, const Args&... args)
+{
+	static_assert(sizeof...(Args) % 2 == 0, "log fields are given as key / value pairs");
+
+	LogRecordWriter_ writer{g_logRecordBuffer};
+	writer.fields(args...);
+
+	LogRecord record{severity, message, file, line, writer.record_.first(writer.size_)};
+	dispatchLogRecord_(&record);
+}
+
+////////////////////////////////////////////////////////////
+// Fixed String
+
+template <usize Capacity>
+struct FixedString {
+	constexpr FixedString() = default;
+	constexpr FixedString(const char* s) { *this = s; }
+	constexpr FixedString(Span<const char> s) { *this = s; }
+
+	constexpr FixedString& operator=(const char* s) { return *this = Span(s, sLength(s)); }
+
+	// s does not need to be null-terminated.
+	constexpr FixedString& operator=(Span<const char> s)
+	{
+		MY_ASSERT(s.size <= Capacity - 1, *this);
+		for (usize i = 0; i < s.size; i++) {
+			data_[i] = s.data[i];
+		}
+		data_[s.size] = '\0';
+		size_ = s.size;
+		return *this;
+	}
+
+	constexpr FixedString(const FixedString&) = default;
+	constexpr FixedString& operator=(const FixedString&) = default;
+	constexpr FixedString(FixedString&&) noexcept = default;
+	constexpr FixedString& operator=(FixedString&&) noexcept = default;
+
+	constexpr void clear()
+	{
+		for (usize i = 0; i < size_; i++) {
+			data_[i] = '\0';
+		}
+		size_ = 0;
+	}
+
+	constexpr char* data() { return data_; }
+	constexpr const char* data() const { return data_; }
+	constexpr const char* c_str() const { return data_; }
+
+	constexpr usize size() const { return size_; }
+	constexpr usize capacity() const { return Capacity; }
+
+	constexpr bool empty() const { return size_ == 0; }
+	constexpr bool full() const { return size_ == Capacity - 1; }
+
+	constexpr char* begin() { return data_; }
+	constexpr char* end() { return data_ + size_; }
+	constexpr const char* begin() const { return data_; }
+	constexpr const char* end() const { return data_ + size_; }
+
+	constexpr char* operator[](usize index)
+	{
+		MY_ASSERT(index < size_, nullptr);
+		return &data_[index];
+	}
+	constexpr const char* operator[](usize index) const
+	{
+		MY_ASSERT(index < size_, nullptr);
+		return &data_[index];
+	}
+
+	constexpr operator Span<char>() { return Span(begin(), end()); }
+	constexpr operator Span<const char>() const { return Span(begin(), end()); }
+
+	usize size_ = 0;
+	char data_[Capacity + 1] = {};
+
+	static_assert(Capacity > 0);
+};
+
+////////////////////////////////////////////////////////////
+// String View
+//
+// A StringView is a Span<const char> with string operations. As it knows its
+// length, no operation needs to scan for a null-terminator, and the viewed
+// characters do not need to be null-terminated. Comparisons bail out early on
+// length mismatch and otherwise compare at memcmp speed.
+
+struct StringView : Span<const char> {
+	constexpr StringView() = default;
+	constexpr StringView(const char* s) : Span(s, sLength(s)) {}
+	constexpr StringView(const char* data, usize size) : Span(data, size) {}
+	constexpr StringView(Span<const char> s) : Span(s) {}
+
+	template <usize Capacity>
+	constexpr StringView(const FixedString<Capacity>& s) : Span(s.data(), s.size())
+	{
+	}
+
+	constexpr StringView substr(usize offset, usize subsize = usize(-1)) const { return subspan(offset, subsize); }
+
+	constexpr bool startsWith(StringView prefix) const;
+	constexpr bool endsWith(StringView suffix) const;
+
+	// Returns a pointer to the first occurrence, or nullptr if not found.
+	constexpr const char* find(char c) const;
+	constexpr const char* find(StringView s) const;
+
+	// Splits at the first occurrence of delimiter, which is part of neither
+	// result. Returns false if delimiter is not found.
+	constexpr bool split(char delimiter, StringView* before, StringView* after) const;
+
+	// Strip leading / trailing whitespace.
+	constexpr StringView trimLeft() const;
+	constexpr StringView trimRight() const;
+	constexpr StringView trim() const { return trimLeft().trimRight(); }
+};
+
+inline constexpr i32 sCmp(StringView a, StringView b)
+{
+	usize size = min(a.size, b.size);
+	if (!std::is_constant_evaluated() && size > 0) {
+		if (int result = memcmp(a.data, b.data, size))
+			return result;
+	}
+	else {
+		for (usize i = 0; i < size; i++) {
+			if (a.data[i] != b.data[i])
+				return std::bit_cast<u8>(a.data[i]) - std::bit_cast<u8>(b.data[i]);
+		}
+	}
+	return a.size < b.size ? -1 : a.size > b.size ? 1 : 0;
+}
+
+inline constexpr bool sEq(StringView a, StringView b)
+{
+	return a.size == b.size && sCmp(a, b) == 0;
+}
+
+inline constexpr bool sLess(StringView a, StringView b)
+{
+	return sCmp(a, b) < 0;
+}
+
+inline constexpr bool operator==(StringView a, StringView b)
+{
+	return sEq(a, b);
+}
+
+inline constexpr u64 hash(StringView s, u64 seed = 0)
+{
+	return hash(Span<const char>(s), seed);
+}
+
+// "name"_hash yields hash(StringView("name")) at compile-time, which allows
+// dispatching on strings with a switch instead of a chain of sEq calls:
+//
+//     switch (hash(command)) {
+//     case "quit"_hash: ...
+//     case "load"_hash: ...
+//     }
+//
+// Colliding labels are rejected by the compiler as duplicate cases. Compare
+// the string after a match if input outside the known set must be rejected.
+inline namespace literals {
+consteval u64 operator""_hash(const char* s, usize size)
+{
+	return hash(StringView(s, size));
+}
+} // namespace literals
+
+inline constexpr bool isSpace_(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+constexpr bool StringView::startsWith(StringView prefix) const
+{
+	return size >= prefix.size && sEq(first(prefix.size), prefix);
+}
+
+constexpr bool StringView::endsWith(StringView suffix) const
+{
+	return size >= suffix.size && sEq(last(suffix.size), suffix);
+}
+
+constexpr StringView StringView::trimLeft() const
+{
+	usize i = 0;
+	while (i < size && isSpace_(data[i]))
+		i++;
+	return substr(i);
+}
+
+constexpr StringView StringView::trimRight() const
+{
+	usize n = size;
+	while (n > 0 && isSpace_(data[n - 1]))
+		n--;
+	return substr(0, n);
+}
+
+////////////////////////////////////////////////////////////
+// String Search
+//
+// sFind locates a character or substring, sFindAny the first character that
+// is part of a set. All return a pointer to the match, or nullptr if there is
+// none. Run-time paths are vectorized:
+//
+// - single characters use memchr
+// - small sets (up to 4 characters) test 8 bytes per step (SWAR)
+// - larger sets use a 256 bit membership table
+// - substrings use memchr to find candidates for the first character, which
+//   are filtered by the last character before comparing the remainder
+//
+// sSplit / sSplitAny iterate over the tokens between delimiters without
+// allocating:
+//
+//     for (StringView field : sSplit(line, ',')) { ... }
+//
+// Consecutive delimiters produce empty tokens; an empty string produces a
+// single empty token.
+
+inline constexpr const char* sFind(StringView s, char c)
+{
+	if (!std::is_constant_evaluated()) {
+		return s.size ? static_cast<const char*>(memchr(s.data, c, s.size)) : nullptr;
+	}
+	for (const char& ch : s) {
+		if (ch == c)
+			return &ch;
+	}
+	return nullptr;
+}
+
+inline constexpr u64 zeroBytes_(u64 v)
+{
+	// The lowest set bit marks the first zero byte, higher ones may be false
+	// positives.
+	return (v - 0x0101010101010101) & ~v & 0x8080808080808080;
+}
+
+inline constexpr const char* sFindAny(StringView s, StringView set)
+{
+	if (set.empty())
+		return nullptr;
+	if (set.size == 1)
+		return sFind(s, set.data[0]);
+
+	const char* p = s.begin();
+	const char* end = s.end();
+
+	if (!std::is_constant_evaluated() && set.size <= 4) {
+		u64 broadcast[4];
+		for (usize i = 0; i < 4; i++) {
+			// Unused slots repeat the first character.
+			broadcast[i] = u64(u8(set.data[i < set.size ? i : 0])) * 0x0101010101010101;
+		}
+		for (; end - p >= 8; p += 8) {
+			u64 v = hashLoad64_(p);
+			u64 match = zeroBytes_(v ^ broadcast[0]) | zeroBytes_(v ^ broadcast[1]) | zeroBytes_(v ^ broadcast[2])
+			    | zeroBytes_(v ^ broadcast[3]);
+			if (match)
+				return p + std::countr_zero(match) / 8;
+		}
+	}
+
+	u64 table[4] = {};
+	for (char c : set) {
+		table[u8(c) / 64] |= u64(1) << (u8(c) % 64);
+	}
+	for (; p < end; p++) {
+		if (table[u8(*p) / 64] & (u64(1) << (u8(*p) % 64)))
+			return p;
+	}
+	return nullptr;
+}
+
+inline constexpr const char* sFind(StringView s, StringView needle)
+{
+	if (needle.size == 0)
+		return s.data;
+	if (needle.size > s.size)
+		return nullptr;
+
+	char first = needle.data[0];
+	char last = needle.data[needle.size - 1];
+	StringView candidates = s.first(s.size - needle.size + 1);
+	while (const char* p = sFind(candidates, first)) {
+		if (p[needle.size - 1] == last && sEq(StringView(p, needle.size), needle))
+			return p;
+		candidates = StringView(p + 1, usize(candidates.end() - p - 1));
+	}
+	return nullptr;
+}
+
+struct StringSplit {
+	struct Iterator;
+
+	// Returns false once all tokens have been produced.
+	constexpr bool next(StringView* token)
+	{
+		if (done_)
+			return false;
+
+		const char* p = any_ ? sFindAny(rest_, delimiters_) : sFind(rest_, delimiter_);
+		if (!p) {
+			*token = rest_;
+			done_ = true;
+			return true;
+		}
+
+		*token = StringView(rest_.data, usize(p - rest_.data));
+		rest_ = StringView(p + 1, usize(rest_.end() - p - 1));
+		return true;
+	}
+
+	constexpr Iterator begin() const;
+	constexpr Iterator end() const;
+
+	StringView rest_;
+	char delimiter_ = '\0';
+	StringView delimiters_;
+	bool any_ = false; // split at any of delimiters_ instead of delimiter_
+	bool done_ = false;
+};
+
+struct StringSplit::Iterator {
+	constexpr StringView operator*() const { return token_; }
+
+	constexpr Iterator& operator++()
+	{
+		end_ = !split_.next(&token_);
+		return *this;
+	}
+
+	constexpr bool operator==(const Iterator& other) const { return end_ == other.end_; }
+
+	StringSplit split_;
+	StringView token_;
+	bool end_ = true;
+};
+
+constexpr StringSplit::Iterator StringSplit::begin() const
+{
+	Iterator it{*this, {}, false};
+	return ++it;
+}
+
+constexpr StringSplit::Iterator StringSplit::end() const
+{
+	return {};
+}
+
+inline constexpr StringSplit sSplit(StringView s, char delimiter)
+{
+	return {s, delimiter, {}, false, false};
+}
+
+inline constexpr StringSplit sSplitAny(StringView s, StringView delimiters)
+{
+	return {s, '\0', delimiters, true, false};
+}
+
+constexpr const char* StringView::find(char c) const
+{
+	return sFind(*this, c);
+}
+
+constexpr const char* StringView::find(StringView s) const
+{
+	return sFind(*this, s);
+}
+
+constexpr bool StringView::split(char delimiter, StringView* before, StringView* after) const
+{
+	const char* p = sFind(*this, delimiter);
+	if (!p)
+		return false;
+	*before = StringView(data, usize(p - data));
+	*after = StringView(p + 1, usize(end() - p - 1));
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+// String Builder
+//
+// Appends to a null-terminated string in a Span<char> or FixedString while
+// tracking its length, so composing larger strings does not rescan them.
+// Integers and floats are converted like by sPrint.
+//
+//     StringBuilder builder(&fixedString);
+//     builder.append("id: ").appendHex(id, 8).append(" value: ").appendPadded(value, 6);
+//
+// On overflow, the Truncate policy appends as much as fits while the Assert
+// policy triggers an assertion and appends nothing. Either way, truncated()
+// reports the overflow.
+
+struct StringBuilder {
+	enum class Overflow { Truncate, Assert };
+
+	// Nothing is written to an empty dst, not even a terminator.
+	explicit StringBuilder(Span<char> dst, Overflow overflow = Overflow::Truncate)
+	    : data_(dst.size ? dst.data : nullptr), capacity_(dst.size ? dst.size - 1 : 0), overflow_(overflow)
+	{
+		if (data_) {
+			data_[0] = '\0';
+		}
+	}
+
+	// Appends to the existing contents, keeping the FixedString's size updated.
+	template <usize Capacity>
+	explicit StringBuilder(FixedString<Capacity>* s, Overflow overflow = Overflow::Truncate)
+	    : data_(s->data_), capacity_(Capacity - 1), size_(s->size_), overflow_(overflow), fixedSize_(&s->size_)
+	{
+	}
+
+	StringBuilder(const StringBuilder&) = delete;
+	StringBuilder& operator=(const StringBuilder&) = delete;
+
+	StringBuilder& append(const char* s)
+	{
+		MY_ASSERT(s, *this);
+		return append(Span(s, sLength(s)));
+	}
+
+	StringBuilder& append(Span<const char> s)
+	{
+		put(s.data, s.size);
+		return *this;
+	}
+
+	StringBuilder& append(char c)
+	{
+		put(&c, 1);
+		return *this;
+	}
+
+	template <typename T>
+	    requires(std::is_arithmetic_v<T> || std::is_enum_v<T>)
+	StringBuilder& append(T v)
+	{
+		char buffer[FloatFormatSize_];
+		FormatWriter_ writer(buffer);
+		writer.arg(v, false);
+		put(buffer, writer.size_);
+		return *this;
+	}
+
+	// Appends at least minDigits hexadecimal digits, padded with zeros.
+	StringBuilder& appendHex(u64 v, usize minDigits = 0)
+	{
+		char buffer[16];
+		char* end = buffer + sizeof(buffer);
+		char* begin = formatHex_(end, v);
+		usize digits = usize(end - begin);
+		usize zeros = min(minDigits, sizeof(buffer)) - min(minDigits, digits);
+		if (!reserve(zeros + digits))
+			return *this;
+		pad(zeros, '0');
+		put(begin, digits);
+		return *this;
+	}
+
+	StringBuilder& pad(usize count, char fill = ' ')
+	{
+		if (!reserve(count))
+			return *this;
+		count = min(count, capacity_ - size_);
+		if (count > 0) {
+			memset(data_ + size_, fill, count);
+		}
+		commit(count);
+		return *this;
+	}
+
+	// Appends v, padded to width characters. Positive widths align to the right,
+	// negative ones to the left.
+	template <typename T>
+	StringBuilder& appendPadded(const T& v, i32 width, char fill = ' ')
+	{
+		usize start = size_;
+		append(v);
+
+		usize length = size_ - start;
+		usize target = usize(width < 0 ? -i64(width) : i64(width));
+		if (length >= target)
+			return *this;
+
+		usize count = target - length;
+		if (width < 0)
+			return pad(count, fill);
+		if (!reserve(count))
+			return *this;
+
+		// Padding is dropped before any character of the value.
+		count = min(count, capacity_ - size_);
+		if (count > 0) {
+			memmove(data_ + start + count, data_ + start, length);
+			memset(data_ + start, fill, count);
+		}
+		commit(count);
+		return *this;
+	}
+
+	void clear()
+	{
+		size_ = 0;
+		truncated_ = false;
+		commit(0);
+	}
+
+	const char* c_str() const { return data_ ? data_ : ""; }
+	usize size() const { return size_; }
+	usize capacity() const { return capacity_; }
+	bool truncated() const { return truncated_; }
+
+	operator Span<const char>() const { return Span<const char>(data_, size_); }
+
+	// Checks whether count more characters fit, applying the overflow policy.
+	// With Truncate, callers must clamp to the remaining capacity.
+	bool reserve(usize count)
+	{
+		if (count <= capacity_ - size_)
+			return true;
+		truncated_ = true;
+		MY_ASSERT(overflow_ != Overflow::Assert, false);
+		return true;
+	}
+
+	void put(const char* s, usize length)
+	{
+		if (!reserve(length))
+			return;
+		length = min(length, capacity_ - size_);
+		if (length > 0) {
+			memcpy(data_ + size_, s, length);
+		}
+		commit(length);
+	}
+
+	void commit(usize count)
+	{
+		size_ += count;
+		if (data_) {
+			data_[size_] = '\0';
+		}
+		if (fixedSize_) {
+			*fixedSize_ = size_;
+		}
+	}
+
+	char* data_ = nullptr;
+	usize capacity_ = 0; // excluding terminator
+	usize size_ = 0;
+	bool truncated_ = false;
+	Overflow overflow_ = Overflow::Truncate;
+	usize* fixedSize_ = nullptr;
+};
+
+////////////////////////////////////////////////////////////
+// String Interner
+//
+// Stores each unique string once and hands out a compact u32 id for it. Ids
+// are dense, start at 0, and stay valid for the lifetime of the interner, so
+// equality of interned strings reduces to comparing ids. hash(id) returns the
+// precomputed hash(StringView) of the string without touching its bytes.
+//
+// Strings and bookkeeping live in an ArenaAllocator and are never moved;
+// view(id) and c_str(id) therefore remain valid until the interner dies.
+//
+// find, view, c_str, and hash are lock-free and may run concurrently with
+// intern. intern takes a lock only when the string is not present yet.
+
+struct StringInterner {
+	static constexpr u32 InvalidId = ~u32(0);
+
+	struct Entry {
+		u64 hash = 0;
+		u32 size = 0;
+
+		// The string follows the entry header, including its terminator.
+		char* data() { return reinterpret_cast<char*>(this + 1); }
+	};
+
+	struct Table {
+		usize mask = 0;
+		std::atomic<u64>* slots = nullptr; // hash tag << 32 | (id + 1), 0 if empty
+	};
+
+	static constexpr usize SegmentBaseSize_ = 64;
+	static constexpr usize SegmentCount_ = 27; // enough to address all u32 ids
+	static constexpr usize MinTableSize_ = 64;
+
+	explicit StringInterner(Allocator* backing = &g_defaultAllocator)
+	    : arena_(ArenaAllocator::DefaultChunkSize, backing)
+	{
+	}
+
+	StringInterner(const StringInterner&) = delete;
+	StringInterner& operator=(const StringInterner&) = delete;
+
+	// Returns the id of s, adding a copy of s first if it is not interned yet.
+	// Returns InvalidId when running out of memory or ids.
+	u32 intern(StringView s);
+
+	// Returns InvalidId if s has not been interned.
+	u32 find(StringView s) const;
+
+	StringView view(u32 id) const
+	{
+		MY_ASSERT(id < size(), StringView());
+		const Entry* entry = entry_(id);
+		return {reinterpret_cast<const char*>(entry + 1), entry->size};
+	}
+
+	const char* c_str(u32 id) const
+	{
+		MY_ASSERT(id < size(), "");
+		return reinterpret_cast<const char*>(entry_(id) + 1);
+	}
+
+	u64 hash(u32 id) const
+	{
+		MY_ASSERT(id < size(), 0);
+		return entry_(id)->hash;
+	}
+
+	// Number of interned strings; ids below this are valid.
+	u32 size() const { return count_.load(std::memory_order_acquire); }
+
+	static void segmentOf_(u32 id, usize* segment, usize* offset)
+	{
+		usize i = usize(id) + SegmentBaseSize_;
+		*segment = usize(std::bit_width(i)) - usize(std::bit_width(SegmentBaseSize_));
+		*offset = i - (SegmentBaseSize_ << *segment);
+	}
+
+	const Entry* entry_(u32 id) const
+	{
+		usize segment, offset;
+		segmentOf_(id, &segment, &offset);
+		return segments_[segment][offset];
+	}
+
+	u32 find_(const Table* table, StringView s, u64 h) const;
+	bool grow_();
+
+	ArenaAllocator arena_;
+	Entry** segments_[SegmentCount_] = {};
+	std::atomic<Table*> table_ = nullptr;
+	std::atomic<u32> count_ = 0;
+	std::atomic<bool> writeLock_ = false;
 };
 
 ////////////////////////////////////////////////////////////
@@ -0,0 +1,52 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+
+TEST_CASE("Default allocator honors alignment", "[Allocator]")
+{
+	for (usize alignment = 1; alignment <= 8192; alignment *= 2) {
+		void* ptr = g_defaultAllocator.alloc(3, alignment);
+		REQUIRE(ptr);
+		REQUIRE(uintptr_t(ptr) % alignment == 0);
+		memset(ptr, 0xFF, 3);
+		g_defaultAllocator.dealloc(ptr);
+	}
+}
+
+TEST_CASE("Default allocator rejects invalid alignment", "[Allocator]")
+{
+	static int assertCount = 0;
+	onAssert = +[](const char*, const char*, long) noexcept { assertCount++; };
+
+	REQUIRE(g_defaultAllocator.alloc(16, 3) == nullptr);
+	REQUIRE(assertCount == 1);
+}
+
+TEST_CASE("Cache aligned allocator", "[Allocator]")
+{
+	void* small = g_cacheAlignedAllocator.alloc(1);
+	REQUIRE(small);
+	REQUIRE(uintptr_t(small) % CacheLineSize == 0);
+	g_cacheAlignedAllocator.dealloc(small);
+
+	void* huge = g_cacheAlignedAllocator.alloc(HugePageSize + 1);
+	REQUIRE(huge);
+	REQUIRE(uintptr_t(huge) % HugePageSize == 0);
+	memset(huge, 0xFF, HugePageSize + 1);
+	g_cacheAlignedAllocator.dealloc(huge);
+}
+
+TEST_CASE("Containers with over-aligned elements", "[Allocator]")
+{
+	struct alignas(64) Padded {
+		int v = 0;
+	};
+
+	Vector<Padded> v;
+	for (int i = 0; i < 10; i++) {
+		v.append({i});
+	}
+	REQUIRE(uintptr_t(v.data()) % 64 == 0);
+}
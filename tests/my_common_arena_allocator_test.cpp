@@ -0,0 +1,105 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+
+TEST_CASE("ArenaAllocator allocates consecutively", "[ArenaAllocator]")
+{
+	ArenaAllocator arena(1024);
+	auto* a = static_cast<u8*>(arena.alloc(16));
+	auto* b = static_cast<u8*>(arena.alloc(16));
+	REQUIRE(a);
+	REQUIRE(b == a + 16);
+	REQUIRE(arena.used() == 32);
+}
+
+TEST_CASE("ArenaAllocator respects alignment", "[ArenaAllocator]")
+{
+	ArenaAllocator arena(1024);
+	arena.alloc(1);
+	usize alignments[] = {2, 4, 8, 16, 64, 256};
+	for (usize alignment : alignments) {
+		void* ptr = arena.alloc(3, alignment);
+		REQUIRE(ptr);
+		REQUIRE(uintptr_t(ptr) % alignment == 0);
+	}
+}
+
+TEST_CASE("ArenaAllocator chains chunks", "[ArenaAllocator]")
+{
+	ArenaAllocator arena(64);
+	for (int i = 0; i < 100; i++) {
+		REQUIRE(arena.alloc(32));
+	}
+	REQUIRE(arena.used() == 100 * 32);
+	REQUIRE(arena.reserved() >= 100 * 32);
+
+	// Oversized allocations get a dedicated chunk.
+	REQUIRE(arena.alloc(1000));
+}
+
+TEST_CASE("ArenaAllocator reset reuses chunks", "[ArenaAllocator]")
+{
+	ArenaAllocator arena(64);
+	void* first = arena.alloc(32);
+	for (int i = 0; i < 10; i++) {
+		arena.alloc(32);
+	}
+	usize reserved = arena.reserved();
+
+	arena.reset();
+	REQUIRE(arena.used() == 0);
+	REQUIRE(arena.alloc(32) == first);
+	for (int i = 0; i < 10; i++) {
+		arena.alloc(32);
+	}
+	REQUIRE(arena.reserved() == reserved);
+
+	arena.release();
+	REQUIRE(arena.reserved() == 0);
+}
+
+TEST_CASE("ArenaAllocator rewind via defer", "[ArenaAllocator]")
+{
+	ArenaAllocator arena(64);
+	arena.alloc(16);
+	void* next = nullptr;
+	{
+		auto marker = arena.marker();
+		MY_DEFER(arena.rewind(marker));
+		next = arena.alloc(16);
+		for (int i = 0; i < 10; i++) {
+			arena.alloc(32);
+		}
+	}
+	REQUIRE(arena.used() == 16);
+	REQUIRE(arena.alloc(16) == next);
+}
+
+TEST_CASE("ArenaAllocator create", "[ArenaAllocator]")
+{
+	struct Foo {
+		int a = 1;
+		double b = 2.0;
+	};
+
+	ArenaAllocator arena;
+	Foo* foo = arena.create<Foo>();
+	REQUIRE(foo->a == 1);
+	REQUIRE(foo->b == 2.0);
+}
+
+TEST_CASE("ArenaAllocator as container allocator", "[ArenaAllocator]")
+{
+	ArenaAllocator arena(256);
+	{
+		Vector<int> v(arena.allocator());
+		for (int i = 0; i < 100; i++) {
+			v.append(i);
+		}
+		REQUIRE(v.size() == 100);
+		REQUIRE(*v[99] == 99);
+	}
+	REQUIRE(arena.used() >= 100 * sizeof(int));
+}
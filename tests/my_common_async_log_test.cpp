@@ -0,0 +1,207 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+#include <atomic>
+#include <thread>
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+TEST_CASE("Async log forwards records to sink", "[AsyncLog]")
+{
+	static int count;
+	static char lastMsg[64];
+	static LogSeverity lastSeverity;
+	count = 0;
+
+	REQUIRE(startAsyncLog(+[](LogSeverity severity, const char* msg, const char*, long) noexcept {
+		count++;
+		sFormat(lastMsg, "%s", msg);
+		lastSeverity = severity;
+	}));
+	REQUIRE(onLog != nullptr);
+
+	MY_WARN("Hello World %d", 42);
+	flushAsyncLog();
+	REQUIRE(count == 1);
+	REQUIRE_THAT(lastMsg, Equals("Hello World 42"));
+	REQUIRE(lastSeverity == LogSeverity::Warning);
+
+	stopAsyncLog();
+	REQUIRE(onLog == nullptr);
+}
+
+TEST_CASE("Async log preserves per-thread order", "[AsyncLog]")
+{
+	constexpr int ThreadCount = 4;
+	constexpr int MessageCount = 1000;
+
+	static std::atomic<int> count;
+	static int next[ThreadCount];
+	static bool ordered;
+	count = 0;
+	ordered = true;
+	for (int& n : next) {
+		n = 0;
+	}
+
+	// Large enough to never drop records in this test.
+	REQUIRE(startAsyncLog(
+	    +[](LogSeverity, const char* msg, const char*, long) noexcept {
+		    int thread = 0, index = 0;
+		    sscanf(msg, "%d %d", &thread, &index);
+		    ordered &= next[thread] == index;
+		    next[thread] = index + 1;
+		    count++;
+	    },
+	    1024 * 1024));
+
+	std::thread threads[ThreadCount];
+	for (int t = 0; t < ThreadCount; t++) {
+		threads[t] = std::thread([t]() {
+			for (int i = 0; i < MessageCount; i++) {
+				MY_INFO("%d %d", t, i);
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	stopAsyncLog();
+	REQUIRE(count == ThreadCount * MessageCount);
+	REQUIRE(ordered);
+}
+
+TEST_CASE("Async log drops records instead of blocking", "[AsyncLog]")
+{
+	static std::atomic<bool> release;
+	static std::atomic<int> count;
+	release = false;
+	count = 0;
+
+	// The sink blocks, so the ring fills up.
+	REQUIRE(startAsyncLog(
+	    +[](LogSeverity, const char*, const char*, long) noexcept {
+		    while (!release) {
+			    std::this_thread::yield();
+		    }
+		    count++;
+	    },
+	    1024));
+
+	u64 dropped = asyncLogDropCount();
+	for (int i = 0; i < 1000; i++) {
+		MY_INFO("Message %d", i);
+	}
+	REQUIRE(asyncLogDropCount() > dropped);
+
+	release = true;
+	stopAsyncLog();
+	REQUIRE(count + int(asyncLogDropCount() - dropped) == 1000);
+}
+
+TEST_CASE("Async log truncates records exceeding a quarter of the ring", "[AsyncLog]")
+{
+	static usize lastLength;
+	REQUIRE(startAsyncLog(
+	    +[](LogSeverity, const char* msg, const char*, long) noexcept { lastLength = sLength(msg); }, 1024));
+
+	u64 truncations = logTruncationCount();
+	MY_INFO("%300d", 1);
+	flushAsyncLog();
+	REQUIRE(lastLength == 256);
+	REQUIRE(logTruncationCount() == truncations + 1);
+
+	MY_INFO("%200d", 1);
+	flushAsyncLog();
+	REQUIRE(lastLength == 200);
+	REQUIRE(logTruncationCount() == truncations + 1);
+
+	stopAsyncLog();
+}
+
+TEST_CASE("Async log wraps around with small gaps", "[AsyncLog]")
+{
+	static int count;
+	static bool intact;
+	count = 0;
+	intact = true;
+
+	// Varying message lengths leave gaps of every possible size in front of
+	// the end of the small ring.
+	REQUIRE(startAsyncLog(
+	    +[](LogSeverity, const char* msg, const char*, long) noexcept {
+		    usize length = usize(count % 97);
+		    intact &= sLength(msg) == length;
+		    for (usize i = 0; i < length; i++) {
+			    intact &= msg[i] == char('a' + i % 26);
+		    }
+		    count++;
+	    },
+	    1024));
+
+	char alphabet[128];
+	for (usize i = 0; i < sizeof(alphabet); i++) {
+		alphabet[i] = char('a' + i % 26);
+	}
+
+	u64 dropped = asyncLogDropCount();
+	for (int i = 0; i < 500; i++) {
+		MY_INFO("%.*s", i % 97, alphabet);
+		flushAsyncLog();
+	}
+	REQUIRE(asyncLogDropCount() == dropped);
+
+	stopAsyncLog();
+	REQUIRE(count == 500);
+	REQUIRE(intact);
+}
+
+TEST_CASE("Async log formats deferred records on the consumer", "[AsyncLog]")
+{
+	static char lastMsg[64];
+	REQUIRE(startAsyncLog(+[](LogSeverity, const char* msg, const char*, long) noexcept {
+		sFormat(lastMsg, "%s", msg);
+	}));
+	REQUIRE(onLogDeferred != nullptr);
+
+	MY_LOG_DEFERRED(LogSeverity::Info, "%s %d %.1f", "deferred", 42, 0.5);
+	flushAsyncLog();
+	REQUIRE_THAT(lastMsg, Equals("deferred 42 0.5"));
+
+	stopAsyncLog();
+	REQUIRE(onLogDeferred == nullptr);
+}
+
+TEST_CASE("Async log spills long deferred records", "[AsyncLog]")
+{
+	static usize lastLength;
+	REQUIRE(startAsyncLog(+[](LogSeverity, const char* msg, const char*, long) noexcept {
+		lastLength = sLength(msg);
+	}));
+
+	MY_LOG_DEFERRED(LogSeverity::Info, "%3000d", 1);
+	flushAsyncLog();
+	REQUIRE(lastLength == 3000);
+
+	stopAsyncLog();
+}
+
+TEST_CASE("Async log flush returns when stopped concurrently", "[AsyncLog]")
+{
+	for (int i = 0; i < 20; i++) {
+		REQUIRE(startAsyncLog(+[](LogSeverity, const char*, const char*, long) noexcept {}));
+
+		std::atomic<bool> stopped = false;
+		std::thread flusher([&]() {
+			while (!stopped)
+				flushAsyncLog();
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		stopAsyncLog();
+		stopped = true;
+		flusher.join();
+	}
+}
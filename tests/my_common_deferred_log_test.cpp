@@ -0,0 +1,97 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+namespace {
+
+char lastMsg[MY_LOG_BUFFER_SIZE];
+
+void captureLog(LogSeverity, const char* msg, const char*, long) noexcept
+{
+	sFormat(lastMsg, "%s", msg);
+}
+
+enum class Color { Red, Green };
+
+} // namespace
+
+TEST_CASE("Deferred log formats via onLog without onLogDeferred", "[DeferredLog]")
+{
+	onLog = captureLog;
+
+	MY_LOG_DEFERRED(LogSeverity::Info, "Hello World %d", 42);
+	REQUIRE_THAT(lastMsg, Equals("Hello World 42"));
+}
+
+TEST_CASE("Deferred log supports printf conversions", "[DeferredLog]")
+{
+	onLog = captureLog;
+
+	const char* str = "str";
+	char arr[] = "arr";
+	MY_LOG_DEFERRED(LogSeverity::Info, "%s %s %c %5.2f %-4d| %x %lld %zu %u %%", str, arr, 'c', 1.5, -3, 255u,
+	    -1234567890123ll, usize(7), unsigned(Color::Green));
+	REQUIRE_THAT(lastMsg, Equals("str arr c  1.50 -3  | ff -1234567890123 7 1 %"));
+
+	MY_LOG_DEFERRED(LogSeverity::Info, "[%*d] [%.*s]", 4, 1, 2, "abc");
+	REQUIRE_THAT(lastMsg, Equals("[   1] [ab]"));
+
+	MY_LOG_DEFERRED(LogSeverity::Info, "%p", nullptr);
+	char expected[32];
+	sFormat(expected, "%p", nullptr);
+	REQUIRE_THAT(lastMsg, Equals(expected));
+}
+
+TEST_CASE("Deferred log hands raw records to onLogDeferred", "[DeferredLog]")
+{
+	static u8 lastRecord[MY_LOG_BUFFER_SIZE];
+	static usize lastRecordSize;
+	static LogSeverity lastSeverity;
+	onLogDeferred = +[](LogSeverity severity, Span<const u8> record, const char*, long) noexcept {
+		memcpy(lastRecord, record.data, record.size);
+		lastRecordSize = record.size;
+		lastSeverity = severity;
+	};
+
+	MY_LOG_DEFERRED(LogSeverity::Warning, "%d + %d = %s", 1, 2, "three");
+	REQUIRE(lastSeverity == LogSeverity::Warning);
+
+	// Format string pointer, two tagged integers, one tagged string.
+	REQUIRE(lastRecordSize == sizeof(const char*) + 2 * (1 + sizeof(i64)) + 1 + sizeof(u32) + 6);
+
+	char buffer[64];
+	REQUIRE(formatDeferredLog(buffer, Span<const u8>(lastRecord, lastRecordSize)) == 14);
+	REQUIRE_THAT(buffer, Equals("1 + 2 = three"));
+}
+
+TEST_CASE("Deferred log truncates oversized arguments", "[DeferredLog]")
+{
+	onLog = captureLog;
+
+	char huge[2 * MY_LOG_BUFFER_SIZE];
+	memset(huge, 'a', sizeof(huge) - 1);
+	huge[sizeof(huge) - 1] = '\0';
+
+	MY_LOG_DEFERRED(LogSeverity::Info, "%s %d", huge, 42);
+	REQUIRE(sLength(lastMsg) < MY_LOG_BUFFER_SIZE);
+	REQUIRE_THAT(lastMsg, EndsWith("<?>"));
+}
+
+TEST_CASE("Deferred log formatting respects buffer size", "[DeferredLog]")
+{
+	static u8 lastRecord[MY_LOG_BUFFER_SIZE];
+	static usize lastRecordSize;
+	onLogDeferred = +[](LogSeverity, Span<const u8> record, const char*, long) noexcept {
+		memcpy(lastRecord, record.data, record.size);
+		lastRecordSize = record.size;
+	};
+
+	MY_LOG_DEFERRED(LogSeverity::Info, "Hello %s", "World");
+
+	char buffer[8];
+	REQUIRE(formatDeferredLog(buffer, Span<const u8>(lastRecord, lastRecordSize)) == 8);
+	REQUIRE_THAT(buffer, Equals("Hello W"));
+}
@@ -0,0 +1,254 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+
+namespace {
+
+struct CollidingKey {
+	bool operator==(const CollidingKey&) const = default;
+	u64 v = 0;
+};
+
+u64 hash(CollidingKey)
+{
+	return 42;
+}
+
+} // namespace
+
+TEST_CASE("HashMap default init", "[HashMap]")
+{
+	HashMap<int, int> map;
+	REQUIRE(map.empty());
+	REQUIRE(map.size() == 0);
+	REQUIRE(map.capacity() == 0);
+	REQUIRE(map.find(42) == nullptr);
+}
+
+TEST_CASE("HashMap insert and find", "[HashMap]")
+{
+	HashMap<int, int> map;
+	REQUIRE(*map.insert(1, 10) == 10);
+	REQUIRE(*map.insert(2, 20) == 20);
+	REQUIRE(map.size() == 2);
+
+	REQUIRE(*map.find(1) == 10);
+	REQUIRE(*map.find(2) == 20);
+	REQUIRE(map.find(3) == nullptr);
+	REQUIRE(map.contains(1));
+	REQUIRE(!map.contains(3));
+}
+
+TEST_CASE("HashMap insert overwrites", "[HashMap]")
+{
+	HashMap<int, int> map;
+	map.insert(1, 10);
+	map.insert(1, 11);
+	REQUIRE(map.size() == 1);
+	REQUIRE(*map.find(1) == 11);
+}
+
+TEST_CASE("HashMap emplace keeps existing value", "[HashMap]")
+{
+	HashMap<int, int> map;
+	REQUIRE(*map.emplace(1, 10) == 10);
+	REQUIRE(*map.emplace(1, 11) == 10);
+	REQUIRE(map.size() == 1);
+}
+
+TEST_CASE("HashMap grows", "[HashMap]")
+{
+	HashMap<u64, u64> map;
+	for (u64 i = 0; i < 10000; i++) {
+		map.insert(i, i * 2);
+	}
+	REQUIRE(map.size() == 10000);
+	REQUIRE(std::has_single_bit(map.capacity()));
+	for (u64 i = 0; i < 10000; i++) {
+		REQUIRE(*map.find(i) == i * 2);
+	}
+	REQUIRE(map.find(10000) == nullptr);
+}
+
+TEST_CASE("HashMap remove", "[HashMap]")
+{
+	HashMap<u64, u64> map;
+	for (u64 i = 0; i < 1000; i++) {
+		map.insert(i, i);
+	}
+	for (u64 i = 0; i < 1000; i += 2) {
+		REQUIRE(map.remove(i));
+	}
+	REQUIRE(!map.remove(0));
+	REQUIRE(map.size() == 500);
+	for (u64 i = 0; i < 1000; i++) {
+		if (i % 2)
+			REQUIRE(*map.find(i) == i);
+		else
+			REQUIRE(map.find(i) == nullptr);
+	}
+}
+
+TEST_CASE("HashMap colliding hashes", "[HashMap]")
+{
+	static int assertCount = 0;
+	onAssert = +[](const char*, const char*, long) noexcept { assertCount++; };
+
+	HashMap<CollidingKey, u64> map;
+	for (u64 i = 0; i < 255; i++) {
+		REQUIRE(map.insert({i}, i));
+	}
+	for (u64 i = 0; i < 255; i++) {
+		REQUIRE(*map.find({i}) == i);
+	}
+	REQUIRE(assertCount == 0);
+
+	REQUIRE(map.insert({255}, 255) == nullptr);
+	REQUIRE(assertCount == 1);
+	REQUIRE(map.size() == 255);
+}
+
+TEST_CASE("HashMap iteration", "[HashMap]")
+{
+	HashMap<int, int> map;
+	for (int i = 0; i < 100; i++) {
+		map.insert(i, i);
+	}
+
+	int count = 0;
+	int sum = 0;
+	for (auto [key, value] : map) {
+		REQUIRE(key == value);
+		sum += value;
+		count++;
+	}
+	REQUIRE(count == 100);
+	REQUIRE(sum == 4950);
+
+	for (auto [key, value] : map) {
+		value = key * 2;
+	}
+	REQUIRE(*map.find(42) == 84);
+
+	static_assert(std::is_same_v<decltype((*map.begin()).key), const int&>);
+	static_assert(std::is_same_v<decltype((*std::as_const(map).begin()).value), const int&>);
+}
+
+TEST_CASE("HashMap insert from own entry", "[HashMap]")
+{
+	HashMap<u64, u64> map;
+	for (u64 i = 0; i < 7; i++) {
+		map.insert(i, i * 10);
+	}
+	REQUIRE(map.capacity() == 8);
+
+	// The value lives in the storage released by growing.
+	REQUIRE(*map.insert(100, *map.find(3)) == 30);
+	REQUIRE(map.capacity() > 8);
+	REQUIRE(*map.emplace(101, *map.find(4)) == 40);
+	REQUIRE(*map.find(3) == 30);
+}
+
+TEST_CASE("HashMap clear and reset", "[HashMap]")
+{
+	HashMap<int, int> map;
+	map.insert(1, 1);
+	map.clear();
+	REQUIRE(map.empty());
+	REQUIRE(map.capacity() > 0);
+	REQUIRE(map.find(1) == nullptr);
+
+	map.reset();
+	REQUIRE(map.capacity() == 0);
+}
+
+TEST_CASE("HashMap copy and move", "[HashMap]")
+{
+	HashMap<int, int> map;
+	map.insert(1, 10);
+
+	HashMap<int, int> copy = map;
+	REQUIRE(*copy.find(1) == 10);
+	REQUIRE(*map.find(1) == 10);
+
+	HashMap<int, int> moved = std::move(map);
+	REQUIRE(*moved.find(1) == 10);
+	REQUIRE(map.empty());
+
+	// Copying an empty map doesn't allocate.
+	HashMap<int, int> emptyCopy = map;
+	REQUIRE(emptyCopy.capacity() == 0);
+	copy = map;
+	REQUIRE(copy.empty());
+	REQUIRE(copy.find(1) == nullptr);
+}
+
+TEST_CASE("HashMap destroys entries", "[HashMap]")
+{
+	struct Counted {
+		Counted(int* count) : count_(count) { (*count_)++; }
+		Counted(Counted&& other) noexcept : count_(other.count_) { (*count_)++; }
+		~Counted() { (*count_)--; }
+		int* count_;
+	};
+
+	int count = 0;
+	{
+		HashMap<int, Counted> map;
+		for (int i = 0; i < 100; i++) {
+			map.emplace(i, &count);
+		}
+		REQUIRE(count == 100);
+		map.remove(0);
+		REQUIRE(count == 99);
+	}
+	REQUIRE(count == 0);
+}
+
+TEST_CASE("HashMap uses given allocator", "[HashMap]")
+{
+	static int allocCount = 0;
+	static int deallocCount = 0;
+	Allocator allocator(
+	    +[](void*, usize size, usize alignment) noexcept {
+		    allocCount++;
+		    return g_defaultAllocator.alloc(size, alignment);
+	    },
+	    +[](void*, void* ptr) noexcept {
+		    deallocCount++;
+		    g_defaultAllocator.dealloc(ptr);
+	    },
+	    nullptr);
+
+	{
+		HashMap<int, int> map(&allocator);
+		map.insert(1, 1);
+		REQUIRE(allocCount == 1);
+	}
+	REQUIRE(deallocCount == 1);
+}
+
+TEST_CASE("HashMap with IdentityHash", "[HashMap]")
+{
+	HashMap<u64, u64, IdentityHash> map;
+	for (u64 i = 0; i < 1000; i++) {
+		map.insert(i * 4096, i);
+	}
+	for (u64 i = 0; i < 1000; i++) {
+		REQUIRE(*map.find(i * 4096) == i);
+	}
+}
+
+TEST_CASE("HashMap with pointer keys", "[HashMap]")
+{
+	static int values[100];
+	HashMap<const int*, usize> map;
+	for (usize i = 0; i < 100; i++) {
+		map.insert(&values[i], i);
+	}
+	for (usize i = 0; i < 100; i++) {
+		REQUIRE(*map.find(&values[i]) == i);
+	}
+}
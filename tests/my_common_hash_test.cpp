@@ -0,0 +1,191 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+
+namespace {
+
+constexpr usize MaxLength = 200;
+
+constexpr u64 hashPattern(usize size)
+{
+	u8 buffer[MaxLength] = {};
+	for (usize i = 0; i < size; i++) {
+		buffer[i] = u8(i * 7 + 1);
+	}
+	return hashRange(buffer, size);
+}
+
+struct HashTable {
+	u64 hashes[MaxLength + 1] = {};
+};
+
+constexpr HashTable compileTimeHashes = []() {
+	HashTable table;
+	for (usize i = 0; i <= MaxLength; i++) {
+		table.hashes[i] = hashPattern(i);
+	}
+	return table;
+}();
+
+} // namespace
+
+TEST_CASE("hashRange is identical at compile-time and run-time", "[Hash]")
+{
+	for (usize i = 0; i <= MaxLength; i++) {
+		REQUIRE(hashPattern(i) == compileTimeHashes.hashes[i]);
+	}
+}
+
+TEST_CASE("hashRange distinguishes lengths and contents", "[Hash]")
+{
+	for (usize i = 0; i <= MaxLength; i++) {
+		for (usize j = i + 1; j <= MaxLength; j++) {
+			REQUIRE(compileTimeHashes.hashes[i] != compileTimeHashes.hashes[j]);
+		}
+	}
+
+	u8 zeros[64] = {};
+	REQUIRE(hashRange(zeros, 1) != hashRange(zeros, 2));
+	REQUIRE(hashRange(zeros, 0) != hashRange(zeros, 1));
+}
+
+TEST_CASE("hashRange handles unaligned input", "[Hash]")
+{
+	alignas(8) u8 buffer[MaxLength + 8] = {};
+	for (usize offset = 0; offset < 8; offset++) {
+		for (usize i = 0; i < MaxLength; i++) {
+			buffer[offset + i] = u8(i * 7 + 1);
+		}
+		for (usize size = 0; size <= MaxLength; size += 13) {
+			REQUIRE(hashRange(buffer + offset, size) == compileTimeHashes.hashes[size]);
+		}
+	}
+}
+
+TEST_CASE("hashRange avalanches single bit flips", "[Hash]")
+{
+	u8 buffer[100] = {};
+	u64 base = hashRange(buffer, sizeof(buffer));
+	for (usize bit = 0; bit < sizeof(buffer) * 8; bit++) {
+		buffer[bit / 8] ^= u8(1u << (bit % 8));
+		int flipped = std::popcount(hashRange(buffer, sizeof(buffer)) ^ base);
+		REQUIRE(flipped > 12);
+		REQUIRE(flipped < 52);
+		buffer[bit / 8] ^= u8(1u << (bit % 8));
+	}
+}
+
+TEST_CASE("hash of Span", "[Hash]")
+{
+	u32 values[] = {1, 2, 3};
+	REQUIRE(hash(Span<u32>(values)) == hashRange(reinterpret_cast<const u8*>(values), sizeof(values)));
+
+	constexpr u8 bytes[] = {1, 2, 3};
+	STATIC_REQUIRE(hash(Span<const u8>(bytes)) == hashRange(bytes, sizeof(bytes)));
+	STATIC_REQUIRE(hash128(Span<const u8>(bytes)) == hashRange128(bytes, sizeof(bytes)));
+}
+
+TEST_CASE("Hasher matches hashRange for any chunking", "[Hash]")
+{
+	u8 buffer[500] = {};
+	for (usize i = 0; i < sizeof(buffer); i++) {
+		buffer[i] = u8(i * 13 + 5);
+	}
+
+	usize chunkSizes[] = {1, 3, 16, 47, 48, 49, 96, 100};
+	for (usize size = 0; size <= sizeof(buffer); size += 7) {
+		u64 expected = hashRange(buffer, size);
+		for (usize chunkSize : chunkSizes) {
+			Hasher hasher;
+			for (usize offset = 0; offset < size; offset += chunkSize) {
+				hasher.update(Span<const u8>(buffer, size).subspan(offset, chunkSize));
+			}
+			REQUIRE(hasher.finalize() == expected);
+		}
+	}
+}
+
+TEST_CASE("Hasher with empty updates", "[Hash]")
+{
+	u8 buffer[100] = {};
+	Hasher hasher;
+	hasher.update(Span<const u8>());
+	hasher.update(Span<const u8>(buffer, 60));
+	hasher.update(Span<const u8>());
+	hasher.update(Span<const u8>(buffer + 60, 40));
+	REQUIRE(hasher.finalize() == hashRange(buffer, 100));
+	REQUIRE(Hasher().finalize() == hashRange(buffer, 0));
+}
+
+TEST_CASE("hash of integers is the identity", "[Hash]")
+{
+	REQUIRE(hash(u64(42)) == 42);
+	REQUIRE(IdentityHash{}(u32(42)) == 42);
+}
+
+TEST_CASE("hashMix avalanches single bit flips", "[Hash]")
+{
+	for (u64 bit = 0; bit < 64; bit++) {
+		int flipped = std::popcount(hashMix(u64(1) << bit) ^ hashMix(0));
+		REQUIRE(flipped > 12);
+		REQUIRE(flipped < 52);
+	}
+}
+
+TEST_CASE("MixedHash spreads aligned pointers over low bits", "[Hash]")
+{
+	alignas(64) static u8 buffer[64 * 256];
+
+	// Using only the low 8 bits, aligned pointers should hit many buckets.
+	bool buckets[256] = {};
+	usize used = 0;
+	for (usize i = 0; i < 256; i++) {
+		u64 h = MixedHash{}(&buffer[i * 64]);
+		if (!buckets[h & 0xFF]) {
+			buckets[h & 0xFF] = true;
+			used++;
+		}
+	}
+	REQUIRE(used > 128);
+}
+
+TEST_CASE("Seeded hashes differ", "[Hash]")
+{
+	u8 buffer[100] = {};
+	for (usize size : {usize(0), usize(3), usize(16), usize(100)}) {
+		REQUIRE(hashRange(buffer, size) == hashRange(buffer, size, 0));
+		REQUIRE(hashRange(buffer, size, 1) != hashRange(buffer, size, 0));
+		REQUIRE(hashRange(buffer, size, 1) != hashRange(buffer, size, 2));
+	}
+}
+
+TEST_CASE("128 bit hash", "[Hash]")
+{
+	u8 buffer[100] = {};
+	for (usize size = 0; size <= sizeof(buffer); size++) {
+		Hash128 h = hashRange128(buffer, size, 7);
+		REQUIRE(h.low == hashRange(buffer, size, 7));
+		REQUIRE(h.low != h.high);
+	}
+
+	Hasher hasher(7);
+	hasher.update(Span<const u8>(buffer, 60));
+	hasher.update(Span<const u8>(buffer + 60, 40));
+	REQUIRE(hasher.finalize() == hashRange(buffer, 100, 7));
+	REQUIRE(hasher.finalize128() == hashRange128(buffer, 100, 7));
+}
+
+TEST_CASE("hashN derives multiple hashes in one pass", "[Hash]")
+{
+	const char key[] = "some key";
+	u64 hashes[4] = {};
+	hashN(Span<const char>(key), Span<u64>(hashes), 3);
+
+	Hash128 h = hash128(Span<const char>(key), 3);
+	REQUIRE(hashes[0] == h.low);
+	for (usize i = 1; i < MY_ARRAYSIZE(hashes); i++) {
+		REQUIRE(hashes[i] - hashes[i - 1] == (h.high | 1u));
+	}
+}
@@ -0,0 +1,142 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+#include <stdio.h>
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+namespace {
+
+constexpr const char* Path = "my_common_log_file_test.bin";
+
+struct Entry {
+	LogSeverity severity;
+	long line;
+	FixedString<64> file;
+	FixedString<2048> message;
+};
+
+Vector<u8> readFile()
+{
+	Vector<u8> image;
+	FILE* file = fopen(Path, "rb");
+	REQUIRE(file);
+	u8 buffer[4096];
+	while (usize count = fread(buffer, 1, sizeof(buffer), file)) {
+		image.appendSpan(Span<const u8>(buffer, count));
+	}
+	fclose(file);
+	return image;
+}
+
+Vector<Entry> decode(const Vector<u8>& image)
+{
+	Vector<Entry> entries;
+	auto collect = [](void* userdata, const LogFileEntry* entry) {
+		static_cast<Vector<Entry>*>(userdata)->append({entry->severity, entry->line, entry->file, entry->message});
+	};
+	REQUIRE(decodeLogFile(Span<const u8>(image.data(), image.size()), collect, &entries));
+	return entries;
+}
+
+} // namespace
+
+TEST_CASE("Log file records can be decoded while the file is open", "[LogFile]")
+{
+	REQUIRE(openLogFile(Path, 4096));
+
+	logFileSink(LogSeverity::Warning, "first", "a.cpp", 1);
+	logFileSink(LogSeverity::Error, "second", "b.cpp", 2);
+
+	// Simulates a crash by not closing the file.
+	auto entries = decode(readFile());
+	closeLogFile();
+
+	REQUIRE(entries.size() == 2);
+	REQUIRE(entries[0]->severity == LogSeverity::Warning);
+	REQUIRE(entries[0]->line == 1);
+	REQUIRE(sEq(entries[0]->file.c_str(), "a.cpp"));
+	REQUIRE_THAT(entries[0]->message.c_str(), Equals("first"));
+	REQUIRE(entries[1]->severity == LogSeverity::Error);
+	REQUIRE_THAT(entries[1]->message.c_str(), Equals("second"));
+}
+
+TEST_CASE("Log file keeps the most recent records", "[LogFile]")
+{
+	REQUIRE(openLogFile(Path, 4096));
+
+	for (long i = 0; i < 1000; i++) {
+		char message[16];
+		sFormat(message, "%ld", i);
+		logFileSink(LogSeverity::Info, message, "file.cpp", i);
+	}
+	closeLogFile();
+
+	auto entries = decode(readFile());
+	REQUIRE(entries.size() > 10);
+	REQUIRE(entries.size() < 1000);
+	for (usize i = 0; i < entries.size(); i++) {
+		long expected = 1000 - long(entries.size()) + long(i);
+		REQUIRE(entries[i]->line == expected);
+		char message[16];
+		sFormat(message, "%ld", expected);
+		REQUIRE_THAT(entries[i]->message.c_str(), Equals(message));
+	}
+}
+
+TEST_CASE("Log file truncates long messages", "[LogFile]")
+{
+	REQUIRE(openLogFile(Path, 4096));
+
+	static char message[5000];
+	memset(message, 'x', sizeof(message) - 1);
+	u64 truncations = logTruncationCount();
+	logFileSink(LogSeverity::Info, message, "file.cpp", 1);
+	logFileSink(LogSeverity::Info, message, "file.cpp", 2);
+	logFileSink(LogSeverity::Info, "short", "file.cpp", 3);
+	closeLogFile();
+	REQUIRE(logTruncationCount() == truncations + 2);
+
+	auto entries = decode(readFile());
+	REQUIRE(entries.size() == 3);
+	REQUIRE(entries[1]->message.size() == 1024);
+	REQUIRE(sEq(entries[2]->message.c_str(), "short"));
+}
+
+TEST_CASE("Log file sink is inactive when closed", "[LogFile]")
+{
+	logFileSink(LogSeverity::Info, "dropped", "file.cpp", 1);
+}
+
+TEST_CASE("Log file decoding rejects invalid images", "[LogFile]")
+{
+	auto ignore = [](void*, const LogFileEntry*) {};
+
+	u8 garbage[256] = {1, 2, 3};
+	REQUIRE_FALSE(decodeLogFile(garbage, ignore));
+
+	REQUIRE(openLogFile(Path, 4096));
+	logFileSink(LogSeverity::Info, "message", "file.cpp", 1);
+	closeLogFile();
+
+	auto image = readFile();
+	REQUIRE(decodeLogFile(Span<const u8>(image.data(), image.size()), ignore));
+	REQUIRE_FALSE(decodeLogFile(Span<const u8>(image.data(), image.size() - 1), ignore));
+
+	*image[CacheLineSize] = 3; // corrupt record size
+	REQUIRE_FALSE(decodeLogFile(Span<const u8>(image.data(), image.size()), ignore));
+}
+
+TEST_CASE("Log file size must be a power of 2", "[LogFile]")
+{
+	static int assertCount;
+	assertCount = 0;
+	onAssert = +[](const char*, const char*, long) noexcept { assertCount++; };
+
+	REQUIRE_FALSE(openLogFile(Path, 5000));
+	REQUIRE(assertCount == 1);
+
+	remove(Path);
+}
@@ -29,6 +29,100 @@ TEST_CASE("Trace logs should be emitted through a use case specific macro", "[Lo
 	MY_TRACE_AUDIO("Audio %d", 42);
 }
 
+TEST_CASE("Trace channels can be toggled at run-time", "[Log]")
+{
+	static int count = 0;
+	onLog = +[](LogSeverity, const char*, const char*, long) noexcept { count++; };
+
+	static constinit LogChannel traceInput{"Input"};
+#define MY_TRACE_INPUT2(...) MY_TRACE(traceInput, __VA_ARGS__)
+
+	MY_TRACE_INPUT2("Input %d", 42);
+	REQUIRE(count == 0);
+
+	traceInput.enabled = true;
+	MY_TRACE_INPUT2("Input %d", 42);
+	REQUIRE(count == 1);
+
+#undef MY_TRACE_INPUT2
+}
+
+TEST_CASE("Messages below the minimum severity are not formatted", "[Log]")
+{
+	static int count = 0;
+	onLog = +[](LogSeverity, const char*, const char*, long) noexcept { count++; };
+
+	int formatted = 0;
+	auto arg = [&]() { return ++formatted; };
+
+	g_logMinSeverity = LogSeverity::Warning;
+	MY_INFO("%d", arg());
+	MY_LOG_DEFERRED(LogSeverity::Info, "%d", arg());
+	REQUIRE(count == 0);
+	REQUIRE(formatted == 0);
+
+	MY_WARN("%d", arg());
+	REQUIRE(count == 1);
+	REQUIRE(formatted == 1);
+}
+
+TEST_CASE("Long messages spill instead of being truncated", "[Log]")
+{
+	static usize lastLength;
+	onLog = +[](LogSeverity, const char* msg, const char*, long) noexcept { lastLength = sLength(msg); };
+
+	static char text[4 * MY_LOG_BUFFER_SIZE];
+	memset(text, 'x', sizeof(text) - 1);
+
+	u64 truncations = logTruncationCount();
+	MY_INFO("%s!", text);
+	REQUIRE(lastLength == sizeof(text));
+	REQUIRE(logTruncationCount() == truncations);
+
+	MY_INFO("short");
+	REQUIRE(lastLength == 5);
+}
+
+TEST_CASE("Messages exceeding the spill limit are truncated", "[Log]")
+{
+	static usize lastLength;
+	onLog = +[](LogSeverity, const char* msg, const char*, long) noexcept { lastLength = sLength(msg); };
+
+	u64 truncations = logTruncationCount();
+	MY_INFO("%*s", int(LogSpillMaxSize), "x");
+	REQUIRE(lastLength == MY_LOG_BUFFER_SIZE - 1);
+	REQUIRE(logTruncationCount() == truncations + 1);
+}
+
+TEST_CASE("Long rate-limited, deferred, and structured messages spill", "[Log]")
+{
+	static usize lastLength;
+	onLog = +[](LogSeverity, const char* msg, const char*, long) noexcept { lastLength = sLength(msg); };
+
+	static char text[4 * MY_LOG_BUFFER_SIZE];
+	memset(text, 'x', sizeof(text) - 1);
+
+	u64 truncations = logTruncationCount();
+
+	for (int i = 0; i < 3; i++) {
+		MY_LOG_EVERY_N(2, LogSeverity::Info, "%s", text);
+	}
+	REQUIRE(lastLength == sizeof(text) - 1 + sLength(" (1 suppressed)"));
+
+	MY_LOG_DEFERRED(LogSeverity::Info, "%3000d", 1);
+	REQUIRE(lastLength == 3000);
+
+	MY_LOG_RECORD(LogSeverity::Info, text, "key", 1);
+	REQUIRE(lastLength == sizeof(text) - 1 + sLength(" key=1"));
+
+	REQUIRE(logTruncationCount() == truncations);
+}
+
+TEST_CASE("Compile-time minimum severity defaults to Trace", "[Log]")
+{
+	STATIC_REQUIRE(MY_LOG_MIN_SEVERITY == int(LogSeverity::Trace));
+}
+
 TEST_CASE("onLog callback disabled in tests by default", "[Log]")
 {
 	REQUIRE(onLog == nullptr);
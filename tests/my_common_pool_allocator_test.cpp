@@ -0,0 +1,89 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+#include <thread>
+
+using namespace MY;
+
+TEST_CASE("PoolAllocator allocates distinct blocks", "[PoolAllocator]")
+{
+	PoolAllocator pool(24, 8, 4);
+	REQUIRE(pool.blockSize() == 24);
+
+	void* blocks[10] = {};
+	for (void*& block : blocks) {
+		block = pool.alloc();
+		REQUIRE(block);
+		memset(block, 0xFF, 24);
+	}
+	for (usize i = 0; i < MY_ARRAYSIZE(blocks); i++) {
+		for (usize j = i + 1; j < MY_ARRAYSIZE(blocks); j++) {
+			REQUIRE(blocks[i] != blocks[j]);
+		}
+	}
+}
+
+TEST_CASE("PoolAllocator respects alignment", "[PoolAllocator]")
+{
+	PoolAllocator pool(3, 16);
+	REQUIRE(pool.blockSize() == 16);
+	for (int i = 0; i < 10; i++) {
+		REQUIRE(uintptr_t(pool.alloc()) % 16 == 0);
+	}
+}
+
+TEST_CASE("PoolAllocator reuses freed blocks", "[PoolAllocator]")
+{
+	PoolAllocator pool(32);
+	void* a = pool.alloc();
+	void* b = pool.alloc();
+	pool.dealloc(a);
+	pool.dealloc(b);
+	REQUIRE(pool.alloc() == b);
+	REQUIRE(pool.alloc() == a);
+}
+
+TEST_CASE("PoolAllocator remote deallocation", "[PoolAllocator]")
+{
+	constexpr usize Count = 4096;
+
+	PoolAllocator pool(32);
+	void* blocks[Count] = {};
+	for (void*& block : blocks) {
+		block = pool.alloc();
+	}
+
+	std::thread threads[4];
+	for (usize t = 0; t < MY_ARRAYSIZE(threads); t++) {
+		threads[t] = std::thread([&, t]() {
+			for (usize i = t; i < Count; i += MY_ARRAYSIZE(threads)) {
+				pool.deallocRemote(blocks[i]);
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	// All blocks are handed out again before a new slab is needed.
+	PoolAllocator::Slab* slabs = pool.slabs_;
+	for (usize i = 0; i < Count; i++) {
+		REQUIRE(pool.alloc());
+	}
+	REQUIRE(pool.slabs_ == slabs);
+}
+
+TEST_CASE("PoolAllocator as container allocator", "[PoolAllocator]")
+{
+	PoolAllocator pool(sizeof(int) * 64, alignof(int));
+	Vector<int> v(pool.allocator());
+	v.reserve(64);
+	REQUIRE(v.capacity() == 64);
+
+	static int assertCount = 0;
+	onAssert = +[](const char*, const char*, long) noexcept { assertCount++; };
+
+	REQUIRE(pool.allocator()->alloc(sizeof(int) * 65, alignof(int)) == nullptr);
+	REQUIRE(assertCount == 1);
+}
@@ -0,0 +1,100 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+#include <limits>
+#include <random>
+#include <stdlib.h>
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+TEST_CASE("sPrint formats literal text", "[Print]")
+{
+	char buffer[64];
+	REQUIRE(sPrint(buffer, "Hello World") == 12);
+	REQUIRE_THAT(buffer, Equals("Hello World"));
+
+	sPrint(buffer, "{{}} {{{}}}", 1);
+	REQUIRE_THAT(buffer, Equals("{} {1}"));
+
+	REQUIRE(sPrint(buffer, "") == 1);
+	REQUIRE_THAT(buffer, Equals(""));
+}
+
+TEST_CASE("sPrint formats integers", "[Print]")
+{
+	char buffer[128];
+
+	sPrint(buffer, "{} {} {} {} {} {}", 0, 9, 10, 99, 100, 12345);
+	REQUIRE_THAT(buffer, Equals("0 9 10 99 100 12345"));
+
+	sPrint(buffer, "{} {}", std::numeric_limits<i64>::min(), std::numeric_limits<u64>::max());
+	REQUIRE_THAT(buffer, Equals("-9223372036854775808 18446744073709551615"));
+
+	sPrint(buffer, "{} {} {}", i8(-128), u8(255), i16(-1));
+	REQUIRE_THAT(buffer, Equals("-128 255 -1"));
+
+	sPrint(buffer, "{:x} {:x} {:x}", 255u, i32(-1), u64(0));
+	REQUIRE_THAT(buffer, Equals("ff ffffffff 0"));
+
+	std::mt19937_64 rng(42);
+	for (int i = 0; i < 1000; i++) {
+		auto v = i64(rng());
+		char expected[32];
+		sFormat(expected, "%lld", (long long)v);
+		sPrint(buffer, "{}", v);
+		REQUIRE_THAT(buffer, Equals(expected));
+	}
+}
+
+TEST_CASE("sPrint formats other types", "[Print]")
+{
+	char buffer[128];
+
+	enum class Color : u8 { Red, Green };
+	sPrint(buffer, "{} {} {} {}", true, false, 'c', Color::Green);
+	REQUIRE_THAT(buffer, Equals("true false c 1"));
+
+	const char* null = nullptr;
+	FixedString<16> fixed = "fixed";
+	Span<const char> span("span!", 4);
+	sPrint(buffer, "{} {} {} {}", "literal", null, fixed, span);
+	REQUIRE_THAT(buffer, Equals("literal (null) fixed span"));
+
+	sPrint(buffer, "{} {:x}", nullptr, reinterpret_cast<void*>(0xbeef));
+	REQUIRE_THAT(buffer, Equals("0x0 0xbeef"));
+}
+
+TEST_CASE("sPrint formats floats with the shortest round-trip representation", "[Print]")
+{
+	char buffer[64];
+
+	sPrint(buffer, "{} {} {} {}", 0.1, 1.5f, -2.0, 1e300);
+	REQUIRE_THAT(buffer, Equals("0.1 1.5 -2 1e+300"));
+
+	sPrint(buffer, "{} {}", 0.1f, 1.0 / 3.0);
+	REQUIRE_THAT(buffer, Equals("0.1 0.3333333333333333"));
+
+	std::mt19937_64 rng(42);
+	for (int i = 0; i < 1000; i++) {
+		f64 v = std::bit_cast<f64>((rng() & ~(u64(0x7ff) << 52)) | (u64(rng() % 0x7ff) << 52));
+		sPrint(buffer, "{}", v);
+		REQUIRE(strtod(buffer, nullptr) == v);
+	}
+}
+
+TEST_CASE("sPrint truncates", "[Print]")
+{
+	char buffer[8];
+	REQUIRE(sPrint(buffer, "{} {}", 123456, "abcdef") == 8);
+	REQUIRE_THAT(buffer, Equals("123456 "));
+
+	REQUIRE(sPrint(Span<char>(), "{}", 1) == 0);
+
+	// Empty destinations with valid data receive no terminator either.
+	buffer[0] = 'x';
+	REQUIRE(sPrint(Span<char>(buffer, usize(0)), "{}", 1) == 0);
+	REQUIRE(sFormat(Span<char>(buffer, usize(0)), "%d", 1) == 0);
+	REQUIRE(buffer[0] == 'x');
+}
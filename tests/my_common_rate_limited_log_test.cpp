@@ -0,0 +1,87 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+#include <thread>
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+namespace {
+
+int count;
+char lastMsg[MY_LOG_BUFFER_SIZE];
+
+void captureLog(LogSeverity, const char* msg, const char*, long) noexcept
+{
+	count++;
+	sFormat(lastMsg, "%s", msg);
+}
+
+} // namespace
+
+TEST_CASE("MY_LOG_EVERY_N emits every n-th message", "[RateLimitedLog]")
+{
+	count = 0;
+	onLog = captureLog;
+
+	for (int i = 0; i < 10; i++) {
+		MY_LOG_EVERY_N(4, LogSeverity::Warning, "Message %d", i);
+		if (i == 0)
+			REQUIRE_THAT(lastMsg, Equals("Message 0"));
+	}
+	REQUIRE(count == 3);
+	REQUIRE_THAT(lastMsg, Equals("Message 8 (3 suppressed)"));
+}
+
+TEST_CASE("MY_LOG_EVERY_N with n = 0 emits every message", "[RateLimitedLog]")
+{
+	count = 0;
+	onLog = captureLog;
+
+	for (int i = 0; i < 3; i++) {
+		MY_LOG_EVERY_N(0, LogSeverity::Warning, "Message %d", i);
+	}
+	REQUIRE(count == 3);
+	REQUIRE_THAT(lastMsg, Equals("Message 2"));
+}
+
+TEST_CASE("MY_LOG_ONCE emits only the first message", "[RateLimitedLog]")
+{
+	count = 0;
+	onLog = captureLog;
+
+	for (int i = 0; i < 10; i++) {
+		MY_LOG_ONCE(LogSeverity::Warning, "Message %d", i);
+	}
+	REQUIRE(count == 1);
+	REQUIRE_THAT(lastMsg, Equals("Message 0"));
+}
+
+TEST_CASE("MY_LOG_EVERY_MS limits messages per interval", "[RateLimitedLog]")
+{
+	count = 0;
+	onLog = captureLog;
+
+	auto log = [](int i) { MY_LOG_EVERY_MS(50, LogSeverity::Warning, "Message %d", i); };
+
+	for (int i = 0; i < 10; i++) {
+		log(i);
+	}
+	REQUIRE(count == 1);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	log(10);
+	REQUIRE(count == 2);
+	REQUIRE_THAT(lastMsg, Equals("Message 10 (9 suppressed)"));
+}
+
+TEST_CASE("Rate-limited call-sites are independent", "[RateLimitedLog]")
+{
+	count = 0;
+	onLog = captureLog;
+
+	MY_LOG_ONCE(LogSeverity::Info, "a");
+	MY_LOG_ONCE(LogSeverity::Info, "b");
+	REQUIRE(count == 2);
+}
@@ -0,0 +1,100 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+TEST_CASE("StringBuilder appends strings and numbers", "[StringBuilder]")
+{
+	char buffer[64];
+	StringBuilder builder(buffer);
+	REQUIRE_THAT(builder.c_str(), Equals(""));
+
+	builder.append("a").append(Span<const char>("bcd", 2)).append('-').append(-42).append(' ').append(u8(7));
+	builder.append(' ').append(0.25).append(' ').append(true);
+	REQUIRE_THAT(buffer, Equals("abc--42 7 0.25 true"));
+	REQUIRE(builder.size() == 19);
+	REQUIRE_FALSE(builder.truncated());
+
+	builder.clear();
+	REQUIRE(builder.size() == 0);
+	REQUIRE_THAT(buffer, Equals(""));
+}
+
+TEST_CASE("StringBuilder appends hex and padding", "[StringBuilder]")
+{
+	char buffer[64];
+	StringBuilder builder(buffer);
+
+	builder.appendHex(0xbeef).append(' ').appendHex(0xbeef, 8).append(' ').appendHex(0, 0);
+	REQUIRE_THAT(buffer, Equals("beef 0000beef 0"));
+
+	builder.clear();
+	builder.append('[').appendPadded(42, 5).append("][").appendPadded("ab", -4, '.').append("][");
+	builder.appendPadded(123456, 3).append(']').pad(2, '*');
+	REQUIRE_THAT(buffer, Equals("[   42][ab..][123456]**"));
+}
+
+TEST_CASE("StringBuilder appends to FixedString", "[StringBuilder]")
+{
+	FixedString<16> s = "id=";
+	StringBuilder builder(&s);
+	builder.append(1234);
+	REQUIRE_THAT(s.c_str(), Equals("id=1234"));
+	REQUIRE(s.size() == 7);
+
+	builder.append("-too-long-for-it");
+	REQUIRE(builder.truncated());
+	REQUIRE(s.size() == 15);
+	REQUIRE_THAT(s.c_str(), Equals("id=1234-too-lon"));
+}
+
+TEST_CASE("StringBuilder truncates by default", "[StringBuilder]")
+{
+	char buffer[8];
+	StringBuilder builder(buffer);
+	builder.append("0123").appendPadded(5, 6);
+	REQUIRE(builder.truncated());
+	REQUIRE(builder.size() == 7);
+	REQUIRE_THAT(buffer, Equals("0123  5"));
+
+	// Padding is dropped before digits of the value.
+	StringBuilder right(buffer);
+	right.append("0").appendPadded(12345, 8);
+	REQUIRE(right.truncated());
+	REQUIRE_THAT(buffer, Equals("0 12345"));
+	right.clear();
+	right.append("01").appendPadded(12345, 6);
+	REQUIRE_THAT(buffer, Equals("0112345"));
+	right.clear();
+	right.append("012").appendPadded(12345, 6);
+	REQUIRE_THAT(buffer, Equals("0121234"));
+
+	StringBuilder empty{Span<char>()};
+	empty.append("x").pad(3);
+	REQUIRE(empty.truncated());
+	REQUIRE_THAT(empty.c_str(), Equals(""));
+
+	// A zero-size span with valid data is not written to.
+	buffer[0] = 'x';
+	StringBuilder zero{Span<char>(buffer, usize(0))};
+	zero.append("y").appendPadded(5, 6).appendPadded(5, -6);
+	REQUIRE(zero.truncated());
+	REQUIRE(zero.size() == 0);
+	REQUIRE(buffer[0] == 'x');
+}
+
+TEST_CASE("StringBuilder asserts on overflow", "[StringBuilder]")
+{
+	static int assertCount;
+	assertCount = 0;
+	onAssert = +[](const char*, const char*, long) noexcept { assertCount++; };
+
+	char buffer[8];
+	StringBuilder builder(buffer, StringBuilder::Overflow::Assert);
+	builder.append("0123").append("45678").appendHex(0x123, 4);
+	REQUIRE(assertCount == 2);
+	REQUIRE(builder.truncated());
+	REQUIRE_THAT(buffer, Equals("0123"));
+}
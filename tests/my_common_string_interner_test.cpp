@@ -0,0 +1,127 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+#include <thread>
+
+using namespace MY;
+
+TEST_CASE("StringInterner returns stable ids", "[StringInterner]")
+{
+	StringInterner interner;
+	REQUIRE(interner.size() == 0);
+	REQUIRE(interner.find("foo") == StringInterner::InvalidId);
+
+	u32 foo = interner.intern("foo");
+	u32 bar = interner.intern("bar");
+	REQUIRE(foo == 0);
+	REQUIRE(bar == 1);
+	REQUIRE(interner.size() == 2);
+
+	REQUIRE(interner.intern("foo") == foo);
+	REQUIRE(interner.find("bar") == bar);
+	REQUIRE(interner.find("baz") == StringInterner::InvalidId);
+	REQUIRE(interner.size() == 2);
+
+	REQUIRE(interner.view(foo) == StringView("foo"));
+	REQUIRE(sEq(interner.c_str(bar), "bar"));
+}
+
+TEST_CASE("StringInterner copies strings", "[StringInterner]")
+{
+	StringInterner interner;
+
+	FixedString<16> name = "player";
+	u32 id = interner.intern(name);
+	name = "enemy";
+
+	REQUIRE(interner.view(id) == StringView("player"));
+	REQUIRE(interner.find("player") == id);
+	REQUIRE(interner.find(name) == StringInterner::InvalidId);
+
+	// Substrings are interned without their surroundings.
+	StringView s = "key=value";
+	REQUIRE(interner.intern(s.substr(0, 3)) == interner.intern("key"));
+	REQUIRE(interner.c_str(interner.find("key"))[3] == '\0');
+
+	u32 empty = interner.intern("");
+	REQUIRE(interner.view(empty).size == 0);
+	REQUIRE(interner.find("") == empty);
+}
+
+TEST_CASE("StringInterner hash matches string hash", "[StringInterner]")
+{
+	StringInterner interner;
+	u32 id = interner.intern("config.window.width");
+	REQUIRE(interner.hash(id) == hash(StringView("config.window.width")));
+}
+
+TEST_CASE("StringInterner grows", "[StringInterner]")
+{
+	constexpr u32 Count = 5000;
+
+	StringInterner interner;
+	for (u32 i = 0; i < Count; i++) {
+		char s[16];
+		sFormat(s, "name%u", i);
+		REQUIRE(interner.intern(s) == i);
+	}
+	REQUIRE(interner.size() == Count);
+
+	for (u32 i = 0; i < Count; i++) {
+		char s[16];
+		sFormat(s, "name%u", i);
+		REQUIRE(interner.find(s) == i);
+		REQUIRE(interner.view(i) == StringView(s));
+	}
+}
+
+TEST_CASE("StringInterner rejects invalid ids", "[StringInterner]")
+{
+	static int assertCount = 0;
+	onAssert = +[](const char*, const char*, long) noexcept { assertCount++; };
+
+	StringInterner interner;
+	interner.intern("foo");
+
+	REQUIRE(interner.view(1).size == 0);
+	REQUIRE(sEq(interner.c_str(StringInterner::InvalidId), ""));
+	REQUIRE(interner.hash(7) == 0);
+	REQUIRE(assertCount == 3);
+}
+
+TEST_CASE("StringInterner concurrent intern and find", "[StringInterner]")
+{
+	constexpr u32 Count = 2000;
+
+	StringInterner interner;
+
+	// Every thread interns the same strings; all must agree on the ids.
+	u32 ids[4][Count] = {};
+	std::atomic<u32> mismatches = 0;
+	std::thread threads[4];
+	for (usize t = 0; t < MY_ARRAYSIZE(threads); t++) {
+		threads[t] = std::thread([&, t]() {
+			for (u32 i = 0; i < Count; i++) {
+				char s[16];
+				sFormat(s, "key%u", (i * 7 + u32(t) * 13) % Count);
+				u32 id = interner.intern(s);
+				ids[t][(i * 7 + u32(t) * 13) % Count] = id;
+				if (interner.view(id) != StringView(s) || interner.find(s) != id) {
+					mismatches++;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	REQUIRE(mismatches == 0);
+	REQUIRE(interner.size() == Count);
+	for (u32 i = 0; i < Count; i++) {
+		REQUIRE(ids[1][i] == ids[0][i]);
+		REQUIRE(ids[2][i] == ids[0][i]);
+		REQUIRE(ids[3][i] == ids[0][i]);
+	}
+}
@@ -0,0 +1,147 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+#include <random>
+
+using namespace MY;
+
+namespace {
+
+const char* naiveFindAny(StringView s, StringView set)
+{
+	for (const char& c : s) {
+		for (char d : set) {
+			if (c == d)
+				return &c;
+		}
+	}
+	return nullptr;
+}
+
+const char* naiveFind(StringView s, StringView needle)
+{
+	for (usize i = 0; i + needle.size <= s.size; i++) {
+		if (memcmp(s.data + i, needle.data, needle.size) == 0)
+			return s.data + i;
+	}
+	return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("sFind character", "[StringSearch]")
+{
+	StringView s = "hello world";
+	REQUIRE(sFind(s, 'o') == s.data + 4);
+	REQUIRE(sFind(s, 'x') == nullptr);
+	REQUIRE(sFind(StringView(), 'x') == nullptr);
+
+	STATIC_REQUIRE(*sFind("abc", 'b') == 'b');
+}
+
+TEST_CASE("sFindAny", "[StringSearch]")
+{
+	StringView s = "key: value\tcomment";
+	REQUIRE(sFindAny(s, ":") == s.data + 3);
+	REQUIRE(sFindAny(s, "\t ") == s.data + 4);
+	REQUIRE(sFindAny(s, "#!?") == nullptr);
+	REQUIRE(sFindAny(s, "tvc") == s.data + 5);
+	REQUIRE(sFindAny(s, "0123456789t") == s.data + 17);
+	REQUIRE(sFindAny(s, "") == nullptr);
+	REQUIRE(sFindAny(s, StringView()) == nullptr);
+
+	// An empty set matches nothing, not even null characters.
+	char zeros[16] = {};
+	REQUIRE(sFindAny(StringView(zeros, sizeof(zeros)), "") == nullptr);
+	REQUIRE(sFindAny(StringView(zeros, sizeof(zeros)), StringView()) == nullptr);
+
+	STATIC_REQUIRE(*sFindAny("a,b;c", ";,") == ',');
+}
+
+TEST_CASE("sFindAny matches naive search", "[StringSearch]")
+{
+	std::mt19937 rng(42);
+	char text[100];
+	for (int n = 0; n < 2000; n++) {
+		for (char& c : text) {
+			c = char('a' + rng() % 26);
+		}
+		char set[8];
+		usize setSize = 1 + rng() % sizeof(set);
+		for (usize i = 0; i < setSize; i++) {
+			set[i] = char('a' + rng() % 26);
+		}
+
+		StringView s(text, rng() % sizeof(text));
+		REQUIRE(sFindAny(s, StringView(set, setSize)) == naiveFindAny(s, StringView(set, setSize)));
+	}
+}
+
+TEST_CASE("sFind substring", "[StringSearch]")
+{
+	StringView s = "abababc";
+	REQUIRE(sFind(s, "abc") == s.data + 4);
+	REQUIRE(sFind(s, "abab") == s.data);
+	REQUIRE(sFind(s, "c") == s.data + 6);
+	REQUIRE(sFind(s, "") == s.data);
+	REQUIRE(sFind(s, "abcd") == nullptr);
+	REQUIRE(sFind(s, "abababcx") == nullptr);
+
+	// Does not match beyond the end.
+	REQUIRE(sFind(StringView("xxab", 3), "ab") == nullptr);
+	REQUIRE(sFind(StringView("abcabc", 4), "bc") != nullptr);
+
+	STATIC_REQUIRE(sFind("hello world", "wor") != nullptr);
+}
+
+TEST_CASE("sFind substring matches naive search", "[StringSearch]")
+{
+	std::mt19937 rng(42);
+	char text[200];
+	for (int n = 0; n < 2000; n++) {
+		for (char& c : text) {
+			c = char('a' + rng() % 3);
+		}
+		StringView s(text, rng() % sizeof(text));
+		StringView needle(text + rng() % 100, 1 + rng() % 6);
+		REQUIRE(sFind(s, needle) == naiveFind(s, needle));
+	}
+}
+
+TEST_CASE("sSplit", "[StringSearch]")
+{
+	const char* expected[] = {"a", "", "bc", ""};
+	usize count = 0;
+	for (StringView token : sSplit("a,,bc,", ',')) {
+		REQUIRE(count < 4);
+		REQUIRE(token == expected[count]);
+		count++;
+	}
+	REQUIRE(count == 4);
+
+	count = 0;
+	for (StringView token : sSplit("", ',')) {
+		REQUIRE(token.empty());
+		count++;
+	}
+	REQUIRE(count == 1);
+
+	StringSplit split = sSplitAny("k=v; x", "=; ");
+	StringView token;
+	REQUIRE(split.next(&token));
+	REQUIRE(token == "k");
+	REQUIRE(split.next(&token));
+	REQUIRE(token == "v");
+	REQUIRE(split.next(&token));
+	REQUIRE(token.empty());
+	REQUIRE(split.next(&token));
+	REQUIRE(token == "x");
+	REQUIRE_FALSE(split.next(&token));
+
+	// An empty set never matches, not even embedded null characters.
+	split = sSplitAny(StringView("a,\0b", 4), "");
+	REQUIRE(split.next(&token));
+	REQUIRE(token == StringView("a,\0b", 4));
+	REQUIRE_FALSE(split.next(&token));
+}
@@ -2,6 +2,9 @@
 
 #include "catch_amalgamated.hpp"
 
+#include <random>
+#include <stdlib.h>
+
 using namespace MY;
 
 TEST_CASE("sCmp", "[StringUtils]")
@@ -40,6 +43,34 @@ TEST_CASE("sLess", "[StringUtils]")
 	REQUIRE(sLess("", "a"));
 }
 
+TEST_CASE("String utilities are usable at compile-time", "[StringUtils]")
+{
+	STATIC_REQUIRE(sLength("") == 0);
+	STATIC_REQUIRE(sLength("abc") == 3);
+	STATIC_REQUIRE(sEq("abc", "abc"));
+	STATIC_REQUIRE(sLess("abc", "abd"));
+	STATIC_REQUIRE(sCmp("b", "a") > 0);
+}
+
+TEST_CASE("String utilities on long strings", "[StringUtils]")
+{
+	char a[256];
+	char b[256];
+	for (usize length = 0; length < 200; length++) {
+		memset(a, 'x', length);
+		a[length] = '\0';
+		memcpy(b, a, length + 1);
+		REQUIRE(sLength(a) == length);
+		REQUIRE(sEq(a, b));
+
+		if (length > 0) {
+			b[length / 2] = char(0xff);
+			REQUIRE(sLess(a, b));
+			REQUIRE(sCmp(b, a) > 0);
+		}
+	}
+}
+
 TEST_CASE("sFormat", "[StringUtils]")
 {
 	char buffer[64];
@@ -54,3 +85,130 @@ TEST_CASE("sFormat exceeds buffer", "[StringUtils]")
 	REQUIRE(buffer[9] == '\0');
 	REQUIRE(n == 10);
 }
+
+TEST_CASE("sFormat exceeds buffer by terminator", "[StringUtils]")
+{
+	char buffer[11];
+	auto n = sFormat(buffer, "Hello World");
+	REQUIRE(buffer[10] == '\0');
+	REQUIRE(n == 11);
+}
+
+TEST_CASE("sToI", "[StringUtils]")
+{
+	i32 i = 0;
+	REQUIRE(*sToI(Span<const char>("123x", 4), &i) == 'x');
+	REQUIRE(i == 123);
+	REQUIRE(sToI(Span<const char>("-2147483648", 11), &i));
+	REQUIRE(i == -2147483648);
+	REQUIRE(sToI(Span<const char>("+0000000000000000000000042", 26), &i));
+	REQUIRE(i == 42);
+
+	REQUIRE_FALSE(sToI(Span<const char>("2147483648", 10), &i));
+	REQUIRE_FALSE(sToI(Span<const char>(), &i));
+	REQUIRE_FALSE(sToI(Span<const char>("-", 1), &i));
+	REQUIRE_FALSE(sToI(Span<const char>(" 1", 2), &i));
+	REQUIRE(i == 42);
+
+	u64 u = 0;
+	REQUIRE(sToI(Span<const char>("18446744073709551615", 20), &u));
+	REQUIRE(u == 18446744073709551615u);
+	REQUIRE_FALSE(sToI(Span<const char>("18446744073709551616", 20), &u));
+	REQUIRE_FALSE(sToI(Span<const char>("18446744073709551620", 20), &u));
+	REQUIRE_FALSE(sToI(Span<const char>("30000000000000000000", 20), &u));
+	REQUIRE_FALSE(sToI(Span<const char>("99999999999999999999", 20), &u));
+	REQUIRE(sToI(Span<const char>("00018446744073709551615", 23), &u));
+	REQUIRE(sToI(Span<const char>("10000000000000000000", 20), &u));
+	REQUIRE(u == 10000000000000000000u);
+	REQUIRE_FALSE(sToI(Span<const char>("100000000000000000000", 21), &u));
+	REQUIRE_FALSE(sToI(Span<const char>("-1", 2), &u));
+
+	i64 l = 0;
+	REQUIRE(sToI(Span<const char>("-9223372036854775808", 20), &l));
+	REQUIRE(l == INT64_MIN);
+	REQUIRE_FALSE(sToI(Span<const char>("9223372036854775808", 19), &l));
+
+	// Does not read past the end of the span.
+	REQUIRE(*sToI(Span<const char>("12345678901", 9), &l) == '0');
+	REQUIRE(l == 123456789);
+
+	STATIC_REQUIRE([] {
+		u8 v = 0;
+		return sToI(Span<const char>("255", 3), &v) && v == 255;
+	}());
+}
+
+TEST_CASE("sToI matches strtoll", "[StringUtils]")
+{
+	std::mt19937_64 rng(42);
+	for (int n = 0; n < 10000; n++) {
+		char buffer[32];
+		i64 expected = i64(rng()) >> (rng() % 64);
+		usize length = sFormat(buffer, "%lld", (long long)expected) - 1;
+
+		i64 v = 0;
+		REQUIRE(sToI(Span<const char>(buffer, length), &v) == buffer + length);
+		REQUIRE(v == expected);
+	}
+}
+
+TEST_CASE("sToF", "[StringUtils]")
+{
+	auto parse = [](const char* s, f64* v) { return sToF(Span(s, sLength(s)), v); };
+
+	f64 d = 0.0;
+	REQUIRE(*parse("1.5x", &d) == 'x');
+	REQUIRE(d == 1.5);
+	REQUIRE(parse("-0.25e2", &d));
+	REQUIRE(d == -25.0);
+	REQUIRE(parse(".5", &d));
+	REQUIRE(d == 0.5);
+	REQUIRE(*parse("5.e", &d) == 'e');
+	REQUIRE(d == 5.0);
+	REQUIRE(parse("+1E-3", &d));
+	REQUIRE(d == 0.001);
+	REQUIRE(parse("-0", &d));
+	REQUIRE((d == 0.0 && signbit(d)));
+	REQUIRE(parse("0.000e999", &d));
+	REQUIRE(d == 0.0);
+	REQUIRE(parse("123456789012345678901234567890", &d));
+	REQUIRE(d == 123456789012345678901234567890.0);
+	REQUIRE(parse("-inf", &d));
+	REQUIRE((isinf(d) && d < 0.0));
+	REQUIRE(parse("nan", &d));
+	REQUIRE(isnan(d));
+
+	d = 42.0;
+	REQUIRE_FALSE(parse("", &d));
+	REQUIRE_FALSE(parse(".", &d));
+	REQUIRE_FALSE(parse("-", &d));
+	REQUIRE_FALSE(parse("+-1", &d));
+	REQUIRE_FALSE(parse("e5", &d));
+	REQUIRE_FALSE(parse("1e400", &d));
+	REQUIRE(d == 42.0);
+
+	f32 f = 0.0f;
+	REQUIRE(sToF(Span<const char>("0.1", 3), &f));
+	REQUIRE(f == 0.1f);
+	REQUIRE(sToF(Span<const char>("16777217", 8), &f));
+	REQUIRE(f == 16777216.0f);
+}
+
+TEST_CASE("sToF matches strtod", "[StringUtils]")
+{
+	std::mt19937_64 rng(42);
+	for (int n = 0; n < 10000; n++) {
+		char buffer[64];
+		f64 v = std::bit_cast<f64>((rng() & ~(u64(0x7ff) << 52)) | (u64(rng() % 0x7ff) << 52));
+		const char* formats[] = {"%.17g", "%g", "%.3f", "%.10e"};
+		usize length = sFormat(buffer, formats[n % 4], v) - 1;
+
+		f64 parsed = 0.0;
+		const char* end = sToF(Span<const char>(buffer, length), &parsed);
+		if (strtod(buffer, nullptr) == HUGE_VAL || fabs(strtod(buffer, nullptr)) < 2.3e-308) {
+			continue; // out of range
+		}
+		REQUIRE(end == buffer + length);
+		REQUIRE(parsed == strtod(buffer, nullptr));
+	}
+}
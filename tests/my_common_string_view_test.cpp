@@ -0,0 +1,132 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+TEST_CASE("StringView construction", "[StringView]")
+{
+	StringView empty;
+	REQUIRE(empty.empty());
+
+	StringView s = "hello";
+	REQUIRE(s.size == 5);
+
+	FixedString<16> fixed = "fixed";
+	StringView f = fixed;
+	REQUIRE(f.data == fixed.data());
+	REQUIRE(f.size == 5);
+
+	char buffer[] = {'a', 'b', 'c'};
+	StringView span = Span<const char>(buffer);
+	REQUIRE(span.size == 3);
+}
+
+TEST_CASE("StringView comparison", "[StringView]")
+{
+	StringView abc("abcdef", 3);
+	REQUIRE(sEq(abc, "abc"));
+	REQUIRE(abc == "abc");
+	REQUIRE_FALSE(abc == "abcd");
+	REQUIRE_FALSE(abc == "ab");
+	REQUIRE(sCmp(abc, "abd") < 0);
+	REQUIRE(sCmp(abc, "ab") > 0);
+	REQUIRE(sCmp(abc, "abcd") < 0);
+	REQUIRE(sLess(abc, "b"));
+	REQUIRE(sEq(StringView(), ""));
+
+	STATIC_REQUIRE(sEq(StringView("abc"), StringView("abcd", 3)));
+	STATIC_REQUIRE(sCmp(StringView("a"), StringView("b")) < 0);
+}
+
+TEST_CASE("StringView prefix and suffix", "[StringView]")
+{
+	StringView s = "key=value";
+	REQUIRE(s.startsWith("key"));
+	REQUIRE(s.startsWith(""));
+	REQUIRE_FALSE(s.startsWith("value"));
+	REQUIRE(s.endsWith("value"));
+	REQUIRE_FALSE(s.endsWith("key=value!"));
+	REQUIRE(s.substr(4) == "value");
+	REQUIRE(s.substr(4, 2) == "va");
+	REQUIRE(s.substr(20).empty());
+}
+
+TEST_CASE("StringView find and split", "[StringView]")
+{
+	StringView s = "key=value=x";
+	REQUIRE(s.find('=') == s.data + 3);
+	REQUIRE(s.find('?') == nullptr);
+	REQUIRE(s.find("value") == s.data + 4);
+	REQUIRE(s.find("") == s.data);
+	REQUIRE(s.find("valuex") == nullptr);
+
+	StringView key, value;
+	REQUIRE(s.split('=', &key, &value));
+	REQUIRE(key == "key");
+	REQUIRE(value == "value=x");
+	REQUIRE_FALSE(key.split('=', &key, &value));
+	REQUIRE(key == "key");
+}
+
+TEST_CASE("StringView trim", "[StringView]")
+{
+	REQUIRE(StringView(" \t a b \n").trim() == "a b");
+	REQUIRE(StringView("  a ").trimLeft() == "a ");
+	REQUIRE(StringView("  a ").trimRight() == "  a");
+	REQUIRE(StringView("   ").trim().empty());
+}
+
+TEST_CASE("StringView hash matches Span hash", "[StringView]")
+{
+	StringView s("abcdef", 3);
+	REQUIRE(hash(s) == hash(Span<const char>("abc", 3)));
+	REQUIRE(hash(s, 1) != hash(s));
+}
+
+namespace {
+
+int dispatch(StringView command)
+{
+	switch (hash(command)) {
+	case "quit"_hash: return 1;
+	case "load"_hash: return 2;
+	case ""_hash: return 3;
+	case "a somewhat longer command exceeding the 48 byte block size"_hash: return 4;
+	default: return 0;
+	}
+}
+
+} // namespace
+
+TEST_CASE("Literal hash matches run-time hash", "[StringView]")
+{
+	STATIC_REQUIRE("abc"_hash == hash(StringView("abc")));
+	STATIC_REQUIRE("abc"_hash != "abd"_hash);
+
+	char buffer[] = "load";
+	REQUIRE("load"_hash == hash(StringView(buffer)));
+	REQUIRE("load"_hash == hash(Span<const char>(buffer, 4)));
+	REQUIRE("load"_hash == hashRange(reinterpret_cast<const u8*>(buffer), 4));
+
+	// Embedded null-terminators are part of the literal.
+	REQUIRE("a\0b"_hash == hash(StringView("a\0b", 3)));
+	REQUIRE("a\0b"_hash != "a"_hash);
+}
+
+TEST_CASE("switch on literal hash", "[StringView]")
+{
+	REQUIRE(dispatch("quit") == 1);
+	REQUIRE(dispatch(StringView("load file", 4)) == 2);
+	REQUIRE(dispatch("") == 3);
+	REQUIRE(dispatch("a somewhat longer command exceeding the 48 byte block size") == 4);
+	REQUIRE(dispatch("save") == 0);
+}
+
+TEST_CASE("FixedString assign from StringView", "[StringView]")
+{
+	FixedString<8> fixed = StringView("abcdef", 3);
+	REQUIRE(fixed.size() == 3);
+	REQUIRE_THAT(fixed.c_str(), Equals("abc"));
+}
@@ -0,0 +1,207 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+namespace {
+
+enum class Mode : u8 { Read, Write };
+
+LogRecord lastRecord;
+u8 lastFields[MY_LOG_BUFFER_SIZE];
+
+void captureRecord(const LogRecord* record) noexcept
+{
+	lastRecord = *record;
+	memcpy(lastFields, record->fields.data, record->fields.size);
+	lastRecord.fields = Span<const u8>(lastFields, record->fields.size);
+}
+
+} // namespace
+
+TEST_CASE("Log records carry typed fields", "[StructuredLog]")
+{
+	onLogRecord = captureRecord;
+
+	const char* path = "/index.html";
+	MY_LOG_RECORD(LogSeverity::Warning, "request done", "status", 404, "bytes", u64(1234), "ratio", 0.5, "path",
+	    path, "cached", true, "mode", Mode::Write);
+
+	REQUIRE(lastRecord.severity == LogSeverity::Warning);
+	REQUIRE_THAT(lastRecord.message, Equals("request done"));
+
+	Span<const u8> fields = lastRecord.fields;
+	LogField field;
+
+	REQUIRE(nextLogField(&fields, &field));
+	REQUIRE_THAT(field.key, Equals("status"));
+	REQUIRE(field.type == LogFieldType::Int);
+	REQUIRE(field.i == 404);
+
+	REQUIRE(nextLogField(&fields, &field));
+	REQUIRE(field.type == LogFieldType::UInt);
+	REQUIRE(field.u == 1234);
+
+	REQUIRE(nextLogField(&fields, &field));
+	REQUIRE(field.type == LogFieldType::Double);
+	REQUIRE(field.d == 0.5);
+
+	REQUIRE(nextLogField(&fields, &field));
+	REQUIRE(field.type == LogFieldType::String);
+	REQUIRE_THAT(field.string.data, Equals("/index.html"));
+	REQUIRE(field.string.size == 11);
+
+	REQUIRE(nextLogField(&fields, &field));
+	REQUIRE(field.type == LogFieldType::Bool);
+	REQUIRE(field.b);
+
+	REQUIRE(nextLogField(&fields, &field));
+	REQUIRE_THAT(field.key, Equals("mode"));
+	REQUIRE(field.type == LogFieldType::UInt);
+	REQUIRE(field.u == 1);
+
+	REQUIRE_FALSE(nextLogField(&fields, &field));
+	REQUIRE(fields.size == 0);
+}
+
+TEST_CASE("Log records without fields", "[StructuredLog]")
+{
+	onLogRecord = captureRecord;
+
+	MY_LOG_RECORD(LogSeverity::Info, "started");
+	REQUIRE_THAT(lastRecord.message, Equals("started"));
+	REQUIRE(lastRecord.fields.size == 0);
+}
+
+TEST_CASE("Log records fall back to onLog", "[StructuredLog]")
+{
+	static const char* lastMsg;
+	onLog = +[](LogSeverity, const char* msg, const char*, long) noexcept { lastMsg = msg; };
+
+	MY_LOG_RECORD(LogSeverity::Info, "request done", "status", 200, "path", "/", "ok", false);
+	REQUIRE_THAT(lastMsg, Equals("request done status=200 path=/ ok=false"));
+}
+
+TEST_CASE("Log records respect the minimum severity", "[StructuredLog]")
+{
+	static int count;
+	count = 0;
+	onLogRecord = +[](const LogRecord*) noexcept { count++; };
+
+	g_logMinSeverity = LogSeverity::Warning;
+	MY_LOG_RECORD(LogSeverity::Info, "filtered", "a", 1);
+	REQUIRE(count == 0);
+	MY_LOG_RECORD(LogSeverity::Error, "passed", "a", 1);
+	REQUIRE(count == 1);
+}
+
+TEST_CASE("Log records drop fields exceeding the buffer", "[StructuredLog]")
+{
+	onLogRecord = captureRecord;
+
+	static char text[2 * MY_LOG_BUFFER_SIZE];
+	memset(text, 'x', sizeof(text) - 1);
+	MY_LOG_RECORD(LogSeverity::Info, "big", "text", text, "dropped", 1);
+
+	Span<const u8> fields = lastRecord.fields;
+	LogField field;
+	REQUIRE(nextLogField(&fields, &field));
+	REQUIRE(field.type == LogFieldType::String);
+	REQUIRE(field.string.size < MY_LOG_BUFFER_SIZE);
+	REQUIRE(field.string.data[field.string.size] == '\0');
+	REQUIRE_FALSE(nextLogField(&fields, &field));
+}
+
+TEST_CASE("Log records can be rendered as JSON", "[StructuredLog]")
+{
+	onLogRecord = captureRecord;
+
+	MY_LOG_RECORD(LogSeverity::Error, "say \"hi\"\n", "user", "a\\b", "count", -3, "nan", 0.0 / 0.0);
+
+	char json[512];
+	usize size = formatLogRecordJson(json, &lastRecord);
+	REQUIRE(size == sLength(json) + 1);
+
+	char expected[512];
+	sFormat(expected,
+	    "{\"severity\":\"error\",\"file\":\"%s\",\"line\":%ld,\"message\":\"say \\\"hi\\\"\\n\","
+	    "\"user\":\"a\\\\b\",\"count\":-3,\"nan\":null}\n",
+	    lastRecord.file, lastRecord.line);
+	REQUIRE_THAT(json, Equals(expected));
+
+	bool truncated = true;
+	formatLogRecordJson(json, &lastRecord, &truncated);
+	REQUIRE_FALSE(truncated);
+
+	// Too small for the header, but the object is still closed.
+	char small[16];
+	REQUIRE(formatLogRecordJson(small, &lastRecord, &truncated) == 4);
+	REQUIRE_THAT(small, Equals("{}\n"));
+	REQUIRE(truncated);
+}
+
+TEST_CASE("Truncated JSON records remain valid", "[StructuredLog]")
+{
+	onLogRecord = captureRecord;
+
+	static char message[5000];
+	for (usize i = 0; i < sizeof(message) - 1; i++) {
+		message[i] = "ab\"\\\n\x01"[i % 6];
+	}
+	MY_LOG_RECORD(LogSeverity::Info, message, "count", 42, "name", "value");
+
+	// Every size cuts the record at a different position, possibly within an
+	// escape sequence.
+	static char json[2 * sizeof(message)];
+	for (usize size = 4; size < sizeof(json); size++) {
+		bool truncated = false;
+		usize length = formatLogRecordJson(Span(json, size), &lastRecord, &truncated) - 1;
+		REQUIRE(length == sLength(json));
+		REQUIRE(json[0] == '{');
+		REQUIRE_THAT(json + length - 2, Equals("}\n"));
+
+		// Quotes which aren't escaped delimit strings, hence must be balanced.
+		usize quotes = 0;
+		for (usize i = 0; i < length; i++) {
+			if (json[i] == '\\')
+				i++;
+			else if (json[i] == '"')
+				quotes++;
+		}
+		REQUIRE(quotes % 2 == 0);
+
+		bool complete = sFind(json, "\"count\":42,\"name\":\"value\"}") != nullptr;
+		REQUIRE(complete == !truncated);
+		if (size > 200) {
+			REQUIRE(sFind(json, "\"message\":\"ab") != nullptr);
+		}
+	}
+}
+
+TEST_CASE("Log records can be encoded as binary frames", "[StructuredLog]")
+{
+	onLogRecord = captureRecord;
+
+	MY_LOG_RECORD(LogSeverity::Info, "message", "a", 1, "b", "two");
+
+	u8 frame[256];
+	usize size = encodeLogRecord(frame, &lastRecord);
+	REQUIRE(size > 0);
+
+	LogRecord decoded;
+	REQUIRE(decodeLogRecord(Span<const u8>(frame, size), &decoded) == size);
+	REQUIRE(decoded.severity == LogSeverity::Info);
+	REQUIRE(decoded.line == lastRecord.line);
+	REQUIRE_THAT(decoded.message, Equals("message"));
+	REQUIRE_THAT(decoded.file, Equals(lastRecord.file));
+	REQUIRE(decoded.fields.size == lastRecord.fields.size);
+	REQUIRE(memcmp(decoded.fields.data, lastRecord.fields.data, decoded.fields.size) == 0);
+
+	REQUIRE(encodeLogRecord(Span(frame).first(size - 1), &lastRecord) == 0);
+	REQUIRE(decodeLogRecord(Span<const u8>(frame, size - 1), &decoded) == 0);
+
+	frame[size - 5] = 42; // corrupt string field length
+	REQUIRE(decodeLogRecord(Span<const u8>(frame, size), &decoded) == 0);
+}
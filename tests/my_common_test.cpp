@@ -10,6 +10,9 @@ class TestRunListener : public Catch::EventListenerBase {
 	{
 		MY::onAssert = nullptr;
 		MY::onLog = nullptr;
+		MY::onLogDeferred = nullptr;
+		MY::onLogRecord = nullptr;
+		MY::g_logMinSeverity = MY::LogSeverity::Trace;
 	}
 };
 CATCH_REGISTER_LISTENER(TestRunListener)
@@ -0,0 +1,83 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+using namespace Catch::Matchers;
+
+TEST_CASE("TrackingAllocator records live and peak bytes", "[TrackingAllocator]")
+{
+	TrackingAllocator tracker;
+	void* a = tracker.alloc(100);
+	void* b = tracker.alloc(50, 64);
+	REQUIRE(uintptr_t(b) % 64 == 0);
+
+	auto stats = tracker.snapshot();
+	REQUIRE(stats.liveBytes == 150);
+	REQUIRE(stats.peakBytes == 150);
+	REQUIRE(stats.allocCount == 2);
+
+	tracker.dealloc(a);
+	tracker.dealloc(b);
+
+	stats = tracker.snapshot();
+	REQUIRE(stats.liveBytes == 0);
+	REQUIRE(stats.peakBytes == 150);
+	REQUIRE(stats.deallocCount == 2);
+}
+
+TEST_CASE("TrackingAllocator size classes", "[TrackingAllocator]")
+{
+	REQUIRE(TrackingAllocator::sizeClass(0) == 0);
+	REQUIRE(TrackingAllocator::sizeClass(16) == 0);
+	REQUIRE(TrackingAllocator::sizeClass(17) == 1);
+	REQUIRE(TrackingAllocator::sizeClass(32) == 1);
+	REQUIRE(TrackingAllocator::sizeClass(33) == 2);
+	REQUIRE(TrackingAllocator::sizeClass(usize(-1)) == TrackingAllocator::SizeClassCount - 1);
+
+	TrackingAllocator tracker;
+	tracker.dealloc(tracker.alloc(8));
+	tracker.dealloc(tracker.alloc(20));
+	tracker.dealloc(tracker.alloc(30));
+
+	auto stats = tracker.snapshot();
+	REQUIRE(stats.sizeClasses[0] == 1);
+	REQUIRE(stats.sizeClasses[1] == 2);
+}
+
+TEST_CASE("TrackingAllocator as container allocator", "[TrackingAllocator]")
+{
+	TrackingAllocator tracker;
+	{
+		Vector<int> v(tracker.allocator());
+		v.reserve(10);
+		REQUIRE(tracker.snapshot().liveBytes == 10 * sizeof(int));
+	}
+	REQUIRE(tracker.snapshot().liveBytes == 0);
+}
+
+TEST_CASE("TrackingAllocator attributes allocation sites", "[TrackingAllocator]")
+{
+	TrackingAllocator tracker;
+	void* ptr = nullptr;
+	AllocationSite* site = nullptr;
+	{
+		MY_ALLOCATION_SITE();
+		site = g_allocationSite;
+		ptr = tracker.alloc(42);
+	}
+	REQUIRE(g_allocationSite == nullptr);
+	REQUIRE(site);
+	REQUIRE_THAT(site->file, EndsWith("my_common_tracking_allocator_test.cpp"));
+	REQUIRE(site->liveBytes == 42);
+	REQUIRE(site->allocCount == 1);
+
+	bool registered = false;
+	for (AllocationSite* s = g_allocationSites.load(); s; s = s->next_) {
+		registered |= s == site;
+	}
+	REQUIRE(registered);
+
+	tracker.dealloc(ptr);
+	REQUIRE(site->liveBytes == 0);
+}
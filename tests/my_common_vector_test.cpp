@@ -0,0 +1,243 @@
+#include <my_common.hpp>
+
+#include "catch_amalgamated.hpp"
+
+using namespace MY;
+
+namespace {
+
+struct Counted {
+	Counted(int* count) : count_(count) { (*count_)++; }
+	Counted(const Counted& other) : count_(other.count_) { (*count_)++; }
+	Counted(Counted&& other) noexcept : count_(other.count_) { (*count_)++; }
+	~Counted() { (*count_)--; }
+	int* count_;
+};
+
+static_assert(TriviallyRelocatable<int>);
+static_assert(!TriviallyRelocatable<Counted>);
+static_assert(TriviallyRelocatable<Vector<Counted>>);
+
+} // namespace
+
+TEST_CASE("Vector default init", "[Vector]")
+{
+	Vector<int> v;
+	REQUIRE(v.empty());
+	REQUIRE(v.size() == 0);
+	REQUIRE(v.capacity() == 0);
+	REQUIRE(v.data() == nullptr);
+}
+
+TEST_CASE("Vector init", "[Vector]")
+{
+	Vector<int> v = {1, 2, 3};
+	REQUIRE(v.size() == 3);
+	REQUIRE(*v[0] == 1);
+	REQUIRE(*v[1] == 2);
+	REQUIRE(*v[2] == 3);
+
+	int arr[] = {4, 5};
+	Vector<int> v2 = Span<int>(arr);
+	REQUIRE(v2.size() == 2);
+	REQUIRE(*v2.front() == 4);
+	REQUIRE(*v2.back() == 5);
+}
+
+TEST_CASE("Vector append grows geometrically", "[Vector]")
+{
+	Vector<int> v;
+	usize reallocations = 0;
+	usize capacity = 0;
+	for (int i = 0; i < 1000; i++) {
+		v.append(i);
+		if (v.capacity() != capacity) {
+			capacity = v.capacity();
+			reallocations++;
+		}
+	}
+	REQUIRE(v.size() == 1000);
+	REQUIRE(reallocations < 12);
+	for (int i = 0; i < 1000; i++) {
+		REQUIRE(*v[usize(i)] == i);
+	}
+}
+
+TEST_CASE("Vector insert and prepend", "[Vector]")
+{
+	Vector<int> v = {1, 3};
+	v.insert(v.begin() + 1, 2);
+	v.prepend(0);
+	int arr[] = {4, 5};
+	v.appendSpan(Span<int>(arr));
+	v.insertSpan(v.begin(), Span<int>(arr));
+
+	int expected[] = {4, 5, 0, 1, 2, 3, 4, 5};
+	REQUIRE(v.size() == MY_ARRAYSIZE(expected));
+	for (usize i = 0; i < v.size(); i++) {
+		REQUIRE(*v[i] == expected[i]);
+	}
+}
+
+TEST_CASE("Vector append element of itself while growing", "[Vector]")
+{
+	Vector<Vector<int>> v;
+	v.appendEmplace(Vector<int>{1, 2, 3});
+	while (v.size() < v.capacity()) {
+		v.appendEmplace();
+	}
+	v.append(*v[0]);
+	REQUIRE(v.back()->size() == 3);
+	REQUIRE(*(*v.back())[2] == 3);
+}
+
+TEST_CASE("Vector insert element of itself with spare capacity", "[Vector]")
+{
+	Vector<int> v = {1, 2, 3};
+	v.reserve(8);
+	v.insert(v.begin(), *v.back());
+
+	int expected[] = {3, 1, 2, 3};
+	REQUIRE(v.size() == MY_ARRAYSIZE(expected));
+	for (usize i = 0; i < v.size(); i++) {
+		REQUIRE(*v[i] == expected[i]);
+	}
+
+	Vector<Vector<int>> nested;
+	nested.reserve(4);
+	nested.append(Vector<int>{1, 2, 3});
+	nested.append(Vector<int>{4});
+	nested.prepend(*nested.back());
+	REQUIRE(nested.size() == 3);
+	REQUIRE(nested.front()->size() == 1);
+	REQUIRE(*(*nested.front())[0] == 4);
+}
+
+TEST_CASE("Vector insert range of itself with spare capacity", "[Vector]")
+{
+	Vector<int> v = {1, 2, 3};
+	v.reserve(16);
+	usize capacity = v.capacity();
+	v.insertSpan(v.begin(), Span<int>(v.begin() + 1, v.end()));
+
+	int expected[] = {2, 3, 1, 2, 3};
+	REQUIRE(v.capacity() == capacity);
+	REQUIRE(v.size() == MY_ARRAYSIZE(expected));
+	for (usize i = 0; i < v.size(); i++) {
+		REQUIRE(*v[i] == expected[i]);
+	}
+}
+
+TEST_CASE("Vector remove", "[Vector]")
+{
+	Vector<int> v = {0, 1, 2, 3, 4};
+	v.remove(v.begin());
+	v.removeRange(v.begin() + 1, v.begin() + 3);
+
+	REQUIRE(v.size() == 2);
+	REQUIRE(*v[0] == 1);
+	REQUIRE(*v[1] == 4);
+}
+
+TEST_CASE("Vector resize", "[Vector]")
+{
+	Vector<int> v;
+	v.resizeWith(10, 7);
+	REQUIRE(v.size() == 10);
+	REQUIRE(*v[9] == 7);
+
+	v.resize(2);
+	REQUIRE(v.size() == 2);
+
+	v.resize(20);
+	REQUIRE(v.size() == 20);
+	REQUIRE(*v[0] == 7);
+
+	// Growing one element at a time reallocates geometrically.
+	usize reallocations = 0;
+	usize capacity = v.capacity();
+	for (usize i = 0; i < 1000; i++) {
+		v.resizeWith(v.size() + 1, 1);
+		if (v.capacity() != capacity)
+			reallocations++;
+		capacity = v.capacity();
+	}
+	REQUIRE(v.size() == 1020);
+	REQUIRE(reallocations < 10);
+}
+
+TEST_CASE("Vector reserve and shrinkToFit", "[Vector]")
+{
+	Vector<int> v;
+	v.reserve(100);
+	REQUIRE(v.capacity() == 100);
+	v.append(1);
+	v.shrinkToFit();
+	REQUIRE(v.capacity() == 1);
+	REQUIRE(*v[0] == 1);
+}
+
+TEST_CASE("Vector subscript out-of-bounds", "[Vector]")
+{
+	static int assertCount = 0;
+	onAssert = +[](const char*, const char*, long) noexcept { assertCount++; };
+
+	Vector<int> v = {1};
+	REQUIRE(v[1] == nullptr);
+	REQUIRE(assertCount == 1);
+}
+
+TEST_CASE("Vector copy and move", "[Vector]")
+{
+	Vector<int> v = {1, 2, 3};
+
+	Vector<int> copy = v;
+	REQUIRE(copy.size() == 3);
+	REQUIRE(copy.data() != v.data());
+
+	int* data = v.data();
+	Vector<int> moved = std::move(v);
+	REQUIRE(moved.data() == data);
+	REQUIRE(v.empty());
+	REQUIRE(v.data() == nullptr);
+}
+
+TEST_CASE("Vector relocates non-trivial elements", "[Vector]")
+{
+	int count = 0;
+	{
+		Vector<Counted> v;
+		for (int i = 0; i < 100; i++) {
+			v.appendEmplace(&count);
+		}
+		REQUIRE(count == 100);
+		v.remove(v.begin());
+		REQUIRE(count == 99);
+		v.removeRange(v.begin() + 10, v.end());
+		REQUIRE(count == 10);
+	}
+	REQUIRE(count == 0);
+}
+
+TEST_CASE("Vector uses given allocator", "[Vector]")
+{
+	static int allocCount = 0;
+	static int deallocCount = 0;
+	Allocator allocator(
+	    +[](void*, usize size, usize alignment) noexcept {
+		    allocCount++;
+		    return g_defaultAllocator.alloc(size, alignment);
+	    },
+	    +[](void*, void* ptr) noexcept {
+		    deallocCount++;
+		    g_defaultAllocator.dealloc(ptr);
+	    },
+	    nullptr);
+
+	{
+		Vector<int> v(&allocator);
+		v.reserve(8);
+		REQUIRE(allocCount == 1);
+	}
+	REQUIRE(deallocCount == 1);
+}
@@ -0,0 +1,43 @@
+// Prints the records of a log file written by logFileSink, oldest first.
+//
+//   mycommon_log_decode <file>
+
+#include <my_common.hpp>
+
+#include <stdio.h>
+
+using namespace MY;
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <file>\n", argv[0]);
+		return 2;
+	}
+
+	FILE* file = fopen(argv[1], "rb");
+	if (!file) {
+		fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+	MY_DEFER(fclose(file));
+
+	Vector<u8> image;
+	u8 buffer[64 * 1024];
+	while (usize count = fread(buffer, 1, sizeof(buffer), file)) {
+		image.appendSpan(Span<const u8>(buffer, count));
+	}
+
+	auto print = [](void*, const LogFileEntry* entry) {
+		fprintf(stdout, "%llu.%09llu %c [%s:%ld] %s\n", (unsigned long long)(entry->time / 1'000'000'000),
+		    (unsigned long long)(entry->time % 1'000'000'000), toChar(entry->severity), entry->file, entry->line,
+		    entry->message);
+	};
+
+	if (!decodeLogFile(Span<const u8>(image.data(), image.size()), print)) {
+		fprintf(stderr, "%s is not a valid log file\n", argv[1]);
+		return 1;
+	}
+
+	return 0;
+}